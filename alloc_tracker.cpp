@@ -0,0 +1,226 @@
+#include "alloc_tracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <new>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kPhaseCount = (int)AllocPhase::COUNT;
+constexpr int kMaxFrames = 32;
+
+thread_local AllocPhase currentPhase = AllocPhase::OTHER; // 每个线程（服务器的各个工作线程）各自的阶段
+std::atomic<std::uint64_t> phaseCount[kPhaseCount];
+std::atomic<std::uint64_t> phaseBytes[kPhaseCount];
+
+struct GuardRecord {
+    void* ptr;
+    std::size_t size;
+    AllocPhase phase;
+    bool freed;
+    bool growth; // 已由 allowAllocGrowth 登记为扩容
+    int depth;
+    void* frames[kMaxFrames];
+};
+
+// 守卫只对开启它的线程（主循环）生效；换关时生成地图的工作线程不受影响，服务器模式的会话不开守卫，
+// 记录数组因此不加锁
+constexpr int kMaxRecords = 64;
+thread_local bool guardArmed = false;
+bool guardBusy = false; // 正在记录时（backtrace 内部）的分配不再记录
+GuardRecord records[kMaxRecords];
+int recordCount = 0;
+int guardAllocs = 0;
+
+void record(std::size_t size) {
+    const int phase = (int)currentPhase;
+    phaseCount[phase].fetch_add(1, std::memory_order_relaxed);
+    phaseBytes[phase].fetch_add(size, std::memory_order_relaxed);
+}
+
+void guardAllocated(void* p, std::size_t size) {
+    if (!guardArmed || guardBusy) return;
+    ++guardAllocs;
+    if (recordCount == kMaxRecords) return;
+    guardBusy = true;
+    GuardRecord& r = records[recordCount++];
+    r.ptr = p;
+    r.size = size;
+    r.phase = currentPhase;
+    r.freed = false;
+    r.growth = false;
+    r.depth = backtrace(r.frames, kMaxFrames);
+    guardBusy = false;
+}
+
+void guardFreed(void* p) {
+    if (!guardArmed || p == nullptr) return;
+    for (int i = recordCount - 1; i >= 0; --i) {
+        if (records[i].ptr == p && !records[i].freed) {
+            records[i].freed = true;
+            return;
+        }
+    }
+}
+
+void release(void* p) {
+    guardFreed(p);
+    std::free(p);
+}
+
+void* allocate(std::size_t size) {
+    record(size);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        guardAllocated(p, size);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    record(size);
+    const std::size_t a = (std::size_t)align;
+    // aligned_alloc 要求大小是对齐的整数倍
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+        guardAllocated(p, size);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void writeText(int fd, const char* text) {
+    const std::size_t n = std::strlen(text);
+    if (::write(fd, text, n) < 0) return;
+}
+
+} // namespace
+
+const char* allocPhaseName(AllocPhase phase) {
+    switch (phase) {
+        case AllocPhase::OTHER: return "other";
+        case AllocPhase::INPUT: return "input";
+        case AllocPhase::TIMERS: return "timers";
+        case AllocPhase::SPAWN: return "spawn";
+        case AllocPhase::AI: return "ai";
+        case AllocPhase::PROJECTILES: return "projectiles";
+        case AllocPhase::COLLISION: return "collision";
+        case AllocPhase::SWEEP: return "sweep";
+        case AllocPhase::EFFECTS: return "effects";
+        case AllocPhase::RENDER: return "render";
+        case AllocPhase::BACKGROUND: return "background";
+        case AllocPhase::COUNT: break;
+    }
+    return "?";
+}
+
+AllocPhase setAllocPhase(AllocPhase phase) {
+    const AllocPhase previous = currentPhase;
+    currentPhase = phase;
+    return previous;
+}
+
+AllocCounts allocCounts(AllocPhase phase) {
+    const int i = (int)phase;
+    return AllocCounts{phaseCount[i].load(std::memory_order_relaxed), phaseBytes[i].load(std::memory_order_relaxed)};
+}
+
+AllocCounts allocTotal() {
+    AllocCounts total;
+    for (int i = 0; i < kPhaseCount; ++i) {
+        if (i == (int)AllocPhase::BACKGROUND) continue;
+        const AllocCounts c = allocCounts((AllocPhase)i);
+        total.count += c.count;
+        total.bytes += c.bytes;
+    }
+    return total;
+}
+
+void armAllocGuard(bool on) {
+    if (on) {
+        // backtrace() 第一次调用时会加载 libgcc（需要分配内存），先在守卫之外预热
+        static const bool primed = [] {
+            void* frames[1];
+            backtrace(frames, 1);
+            return true;
+        }();
+        (void)primed;
+        recordCount = 0;
+        guardAllocs = 0;
+    }
+    guardArmed = on;
+}
+
+AllocGuardSummary allocGuardSummary() {
+    AllocGuardSummary summary;
+    summary.allocs = guardAllocs;
+    summary.unexpected = guardAllocs - recordCount; // 没记下的无从判断，按未登记算
+    for (int i = 0; i < recordCount; ++i) {
+        if (records[i].growth) {
+            summary.growth++;
+        } else {
+            summary.unexpected++;
+        }
+    }
+    return summary;
+}
+
+void allowAllocGrowth(const void* block) {
+    if (!guardArmed || block == nullptr) return;
+    for (int i = recordCount - 1; i >= 0; --i) {
+        if (records[i].ptr == block && !records[i].freed) {
+            records[i].growth = true;
+            return;
+        }
+    }
+}
+
+void reportAllocGuard(int fd) {
+    for (int i = 0; i < recordCount; ++i) {
+        const GuardRecord& r = records[i];
+        if (r.growth) continue;
+        char line[128];
+        std::snprintf(line, sizeof(line), "%s allocation of %zu bytes in phase %s\n",
+                      r.freed ? "temporary" : "retained", r.size, allocPhaseName(r.phase));
+        writeText(fd, line);
+        backtrace_symbols_fd(r.frames, r.depth, fd);
+        return;
+    }
+    if (guardAllocs > recordCount) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "%d allocations beyond the first %d were not recorded\n",
+                      guardAllocs - recordCount, kMaxRecords);
+        writeText(fd, line);
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    record(size);
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p) guardAllocated(p, size);
+    return p;
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    record(size);
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p) guardAllocated(p, size);
+    return p;
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
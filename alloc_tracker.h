@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// 堆分配统计：本模块替换了全局 operator new / delete，按分配所在线程当前所处的阶段
+// 累计分配次数与字节数（阶段按线程记录，计数全部线程共用）。
+// Game 每帧取差值得到逐帧、逐阶段的分配量，基准结束时一并输出。
+enum class AllocPhase : std::uint8_t {
+    OTHER, // 主循环之外（启动、换关、菜单等）
+    INPUT, // 读键盘 / 自动驾驶
+    TIMERS,
+    SPAWN,
+    AI,
+    PROJECTILES,
+    COLLISION,
+    SWEEP,
+    EFFECTS, // 特效粒子
+    RENDER,
+    BACKGROUND, // 后台线程（提前准备下一关），不计入 allocTotal()
+    COUNT
+};
+
+const char* allocPhaseName(AllocPhase phase);
+
+struct AllocCounts {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+};
+
+// 之后的分配记到 phase 名下，返回原来的阶段
+AllocPhase setAllocPhase(AllocPhase phase);
+AllocCounts allocCounts(AllocPhase phase); // 进程启动以来记到 phase 名下的分配
+AllocCounts allocTotal(); // 除 BACKGROUND 外各阶段之和，即游戏线程上的分配
+
+// 守卫：开启期间的每次分配记下块地址、阶段、大小与调用栈（记录本身不分配内存），
+// 释放时标记。已知的增长点（容器扩容）用 noteGrowth 登记新缓冲区，算作摊还的正常增长；
+// 其余分配——不论帧末是否释放——都是稳态帧里不该出现的。函数名需要链接时带 -rdynamic。
+struct AllocGuardSummary {
+    int allocs = 0;     // 窗口内的分配次数
+    int growth = 0;     // 其中登记为容器扩容的
+    int unexpected = 0; // 其余的（超出记录容量、无从判断的一律算在这里）
+};
+
+void armAllocGuard(bool on);
+AllocGuardSummary allocGuardSummary();
+// 把 block 登记为已知增长点的扩容（守卫未开或 block 不是窗口内分配的则忽略）
+void allowAllocGrowth(const void* block);
+// 把窗口内第一个未登记分配的阶段、大小、是否帧末仍在与调用栈写到 fd
+void reportAllocGuard(int fd);
+
+// 已知增长点在可能扩容的操作之后调用：容量变了就把新缓冲区登记为摊还增长
+template <class Container>
+inline void noteGrowth(const Container& c, std::size_t capacityBefore) {
+    if (c.capacity() != capacityBefore) allowAllocGrowth(c.data());
+}
+
+// 已知增长点的追加：emplace_back 并登记可能发生的扩容
+template <class Container, class... Args>
+inline void growingPush(Container& c, Args&&... args) {
+    const std::size_t before = c.capacity();
+    c.emplace_back(std::forward<Args>(args)...);
+    noteGrowth(c, before);
+}
+
+// 已知增长点的 resize
+template <class Container>
+inline void growingResize(Container& c, std::size_t size) {
+    const std::size_t before = c.capacity();
+    c.resize(size);
+    noteGrowth(c, before);
+}
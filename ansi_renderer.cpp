@@ -0,0 +1,145 @@
+#include "ansi_renderer.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// 每格最坏情况：光标移动 "\x1b[RRR;CCCH"（10 字节）+ 颜色 "\x1b[3N;40m"（8 字节）+ 字符
+constexpr std::size_t kMaxBytesPerCell = 19;
+
+char* appendText(char* p, const char* text) {
+    const std::size_t n = std::strlen(text);
+    std::memcpy(p, text, n);
+    return p + n;
+}
+
+char* appendUInt(char* p, unsigned value) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+} // namespace
+
+AnsiRenderer::AnsiRenderer(int rows, int cols, int fd)
+    : Renderer(rows, cols),
+      fd_(fd),
+      shown_(screenRows_ * screenCols_, Cell{'\0', 0}),
+      out_((std::size_t)screenRows_ * screenCols_ * kMaxBytesPerCell + 64) {
+    if (fd_ == STDOUT_FILENO && isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedTermios_) == 0) {
+        termios raw = savedTermios_;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        restoreTermios_ = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    // 备用屏幕、隐藏光标、清屏
+    const char* enter = "\x1b[?1049h\x1b[?25l\x1b[0m\x1b[2J";
+    flush(enter, std::strlen(enter));
+    sgr_ = 0;
+    // 非阻塞输出：每帧直接把整段积压交给一次 write()，收不下的由内核如实返回短写或 EAGAIN。
+    // 服务器会话的套接字接入时就是非阻塞的；标准输出与外壳共用同一个打开的文件，析构时改回来
+    const int flags = ::fcntl(fd_, F_GETFL);
+    if (flags >= 0 && !(flags & O_NONBLOCK) && ::fcntl(fd_, F_SETFL, flags | O_NONBLOCK) == 0) savedFlags_ = flags;
+}
+
+AnsiRenderer::~AnsiRenderer() {
+    if (savedFlags_ >= 0) ::fcntl(fd_, F_SETFL, savedFlags_);
+    flush(out_.data() + sent_, queued_ - sent_);
+    const char* leave = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    flush(leave, std::strlen(leave));
+    if (restoreTermios_) tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios_);
+}
+
+void AnsiRenderer::present() {
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::size_t written = 0;
+    if (sent_ < queued_) {
+        written = writeSome();
+        if (sent_ < queued_) {
+            lastPresent_ = PresentCost{written, elapsedMs(), queued_ - sent_};
+            return;
+        }
+    }
+
+    char* const begin = out_.data();
+    char* p = begin;
+    int cursorRow = -1;
+    int cursorCol = -1;
+
+    for (int r = 0; r < screenRows_; ++r) {
+        for (int c = 0; c < screenCols_; ++c) {
+            const Cell& cell = cellAt(r, c);
+            Cell& shown = shown_[r * screenCols_ + c];
+            if (cell == shown) continue;
+            shown = cell;
+
+            // 连续的变化格不需要重复移动光标
+            if (r != cursorRow || c != cursorCol) {
+                p = appendText(p, "\x1b[");
+                p = appendUInt(p, (unsigned)r + 1);
+                *p++ = ';';
+                p = appendUInt(p, (unsigned)c + 1);
+                *p++ = 'H';
+            }
+            if (cell.color != sgr_) {
+                if (cell.color == 0) {
+                    p = appendText(p, "\x1b[0m");
+                } else {
+                    p = appendText(p, "\x1b[3");
+                    *p++ = (char)('0' + (cell.color - 1));
+                    p = appendText(p, ";40m");
+                }
+                sgr_ = cell.color;
+            }
+            *p++ = cell.ch;
+            cursorRow = r;
+            cursorCol = c + 1;
+        }
+    }
+
+    sent_ = 0;
+    queued_ = (std::size_t)(p - begin);
+    written += writeSome();
+    lastPresent_ = PresentCost{written, elapsedMs(), queued_ - sent_};
+}
+
+std::size_t AnsiRenderer::writeSome() {
+    // 整段积压一次 write()：快链路一次写完；短写或 EAGAIN 说明对端收不下了，剩下的留到下一帧
+    while (sent_ < queued_) {
+        const ssize_t n = ::write(fd_, out_.data() + sent_, queued_ - sent_);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) sent_ = queued_; // 输出端已关闭，丢弃积压
+            return 0;
+        }
+        sent_ += (std::size_t)n;
+        return (std::size_t)n;
+    }
+    return 0;
+}
+
+void AnsiRenderer::flush(const char* data, std::size_t size) {
+    // 正常情况下一次 write() 写完；只有被信号打断或管道写满时才会循环
+    while (size > 0) {
+        const ssize_t n = ::write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        size -= (std::size_t)n;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <termios.h>
+#include <unistd.h>
+#include "renderer.h"
+
+// 原始 ANSI/VT 后端：present() 把与上一帧不同的格子连同光标移动、颜色切换（SGR）
+// 写进一块预先分配好的缓冲区，整帧一次 write() 送出。输出端设为非阻塞，
+// 没写完（短写或 EAGAIN）的部分留作积压：积压未清空前的 present() 只继续送积压、不比较差量，
+// 这期间的画面变化合并到积压清空后的那一帧里，慢链路不会卡住主循环。
+// 构造时切换到备用屏幕、关闭终端的行缓冲与回显并把输出端设为非阻塞，析构时恢复。
+// fd 默认是本进程的标准输出；服务器会话写到客户端的套接字，终端模式由客户端负责。
+class AnsiRenderer : public Renderer {
+public:
+    AnsiRenderer(int rows, int cols, int fd = STDOUT_FILENO);
+    ~AnsiRenderer() override;
+
+    void present() override;
+
+private:
+    void flush(const char* data, std::size_t size);
+    std::size_t writeSome(); // 不阻塞地送出积压，返回送出的字节数
+
+    int fd_;
+    std::vector<Cell> shown_; // 终端上当前显示的内容
+    std::vector<char> out_;   // 一帧输出的缓冲区，容量按最坏情况（每格都要移光标、换颜色）预留
+    std::size_t sent_ = 0;    // out_ 中 [sent_, queued_) 是还没写出去的积压
+    std::size_t queued_ = 0;
+    int sgr_ = -1;            // 终端当前的颜色编号，-1 表示未知
+    bool restoreTermios_ = false;
+    termios savedTermios_{};
+    int savedFlags_ = -1; // 构造前输出端的文件状态标志；不是 -1 时析构恢复（改回阻塞）
+};
@@ -0,0 +1,98 @@
+#include "arcade_client.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onSignal(int) {
+    interrupted = 1;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= (std::size_t)n;
+    }
+    return true;
+}
+
+} // namespace
+
+int runArcadeClient(const std::string& socketPath) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "%s: bad socket path\n", socketPath.c_str());
+        return 1;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+    const int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || connect(sock, (const sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::fprintf(stderr, "%s: cannot connect: %s\n", socketPath.c_str(), std::strerror(errno));
+        if (sock >= 0) ::close(sock);
+        return 1;
+    }
+
+    termios saved{};
+    const bool restore = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+    if (restore) {
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    struct sigaction sa{};
+    sa.sa_handler = onSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    sigaction(SIGHUP, &sa, nullptr);
+
+    pollfd fds[2] = {{sock, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+    char buf[4096];
+    while (!interrupted) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            const ssize_t n = ::read(sock, buf, sizeof(buf));
+            if (n <= 0) break; // 会话结束
+            if (!writeAll(STDOUT_FILENO, buf, (std::size_t)n)) break;
+        }
+        if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+            const ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+            if (n <= 0) {
+                fds[1].fd = -1; // 标准输入关闭：不再读，继续显示到服务器结束会话
+            } else if (!writeAll(sock, buf, (std::size_t)n)) {
+                break;
+            }
+        }
+    }
+
+    if (restore) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    if (interrupted) {
+        // 服务器还没来得及送出恢复序列
+        const char* leave = "\x1b[0m\x1b[?25h\x1b[?1049l";
+        writeAll(STDOUT_FILENO, leave, std::strlen(leave));
+    }
+    ::close(sock);
+    return 0;
+}
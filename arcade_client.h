@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// 街机服务器（--serve）的瘦客户端：把终端切到非规范模式，按键原样转给服务器，
+// 服务器送来的 ANSI 画面原样写到终端。会话结束（按 Q）或服务器关闭时退出；
+// Ctrl-C 退出时自己恢复终端。返回进程退出码
+int runArcadeClient(const std::string& socketPath);
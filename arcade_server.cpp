@@ -0,0 +1,330 @@
+#include "arcade_server.h"
+#include <cstdio>
+
+#ifdef __linux__
+#include "archetypes.h"
+#include "prefabs.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kBaseRate = 60; // 共用节拍；会话的逻辑帧率需能整除它
+constexpr std::int64_t kBasePeriodNs = 1000000000LL / kBaseRate;
+constexpr int kMaxEvents = 64;
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+bool fillAddress(const std::string& path, sockaddr_un* addr) {
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr->sun_path)) return false;
+    std::memcpy(addr->sun_path, path.c_str(), path.size());
+    return true;
+}
+
+timespec toTimespec(std::chrono::steady_clock::time_point t) {
+    const std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    return timespec{(time_t)(ns / 1000000000LL), (long)(ns % 1000000000LL)};
+}
+
+} // namespace
+
+// 一个工作线程：自己的 epoll 上挂着节拍 timerfd、接收新会话的 eventfd 和各会话的套接字
+class ArcadeServer::Worker {
+public:
+    Worker(const GameOptions& options, std::chrono::steady_clock::time_point epoch) : options_(options) {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        timer_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        // steady_clock 即 CLOCK_MONOTONIC：各线程的节拍都从同一个起点算，拍号一致
+        itimerspec spec{};
+        spec.it_interval = timespec{0, (long)kBasePeriodNs};
+        spec.it_value = toTimespec(epoch + std::chrono::nanoseconds(kBasePeriodNs));
+        timerfd_settime(timer_, TFD_TIMER_ABSTIME, &spec, nullptr);
+        watch(wake_, &wake_);
+        watch(timer_, &timer_);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~Worker() {
+        stopping_ = true;
+        notify();
+        thread_.join();
+        for (const Incoming& in : incoming_) ::close(in.fd);
+        ::close(timer_);
+        ::close(wake_);
+        ::close(epoll_);
+    }
+
+    // 由接入线程调用：把新连接交给本线程，会话在本线程上创建
+    void adopt(int fd, std::uint32_t seed, std::uint64_t serial) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(Incoming{fd, seed, serial});
+        }
+        count_++;
+        notify();
+    }
+
+    std::size_t sessions() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Incoming {
+        int fd;
+        std::uint32_t seed;
+        std::uint64_t serial;
+    };
+    struct Session {
+        int fd = -1;
+        std::unique_ptr<Game> game;
+        std::uint32_t every = 1; // 每几拍运行一帧
+        std::uint32_t phase = 0; // 在这几拍中的哪一拍运行
+        bool closed = false;
+    };
+
+    void watch(int fd, void* tag) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = tag;
+        epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void notify() {
+        const std::uint64_t one = 1;
+        if (::write(wake_, &one, sizeof(one)) < 0) return;
+    }
+
+    void run() {
+        epoll_event events[kMaxEvents];
+        while (!stopping_) {
+            const int n = epoll_wait(epoll_, events, kMaxEvents, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            std::uint64_t beats = 0;
+            for (int i = 0; i < n; ++i) {
+                void* tag = events[i].data.ptr;
+                std::uint64_t value = 0;
+                if (tag == &timer_) {
+                    if (::read(timer_, &value, sizeof(value)) == (ssize_t)sizeof(value)) beats = value;
+                } else if (tag == &wake_) {
+                    if (::read(wake_, &value, sizeof(value)) < 0) continue;
+                    openIncoming();
+                } else {
+                    Session& s = *static_cast<Session*>(tag);
+                    if (events[i].events & EPOLLIN) readInput(s);
+                    if (events[i].events & (EPOLLHUP | EPOLLERR)) s.closed = true;
+                }
+            }
+            // 落后时不追帧：错过的拍直接跳过，拍号仍与其它线程一致
+            if (beats > 0) {
+                beat_ += beats;
+                tick();
+            }
+            reap();
+        }
+        for (std::unique_ptr<Session>& s : sessions_) s->closed = true;
+        reap();
+    }
+
+    void openIncoming() {
+        std::vector<Incoming> incoming;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming.swap(incoming_);
+        }
+        for (const Incoming& in : incoming) {
+            GameOptions options = options_;
+            options.render = RenderBackend::ANSI;
+            options.sessionFd = in.fd;
+            options.seed = in.seed;
+            // 分配守卫的记录是进程内共用的，只能给单独运行的那一局用；多个会话同时开着会互相踩
+            options.allocCheck = false;
+            // 快照环按会话编号各用一块共享内存：NAME-0、NAME-1……
+            if (!options.snapshotName.empty()) options.snapshotName += "-" + std::to_string(in.serial);
+            if (!options.eventLogPath.empty()) options.eventLogPath += "-" + std::to_string(in.serial);
+            auto s = std::make_unique<Session>();
+            s->fd = in.fd;
+            s->game = std::make_unique<Game>(options);
+            s->every = (std::uint32_t)(kBaseRate / s->game->tickRate());
+            s->phase = (std::uint32_t)(in.serial % s->every);
+            s->game->begin();
+            s->game->frame(); // 画出菜单（自动驾驶则直接开局）
+            if (!s->game->running()) s->closed = true;
+            watch(in.fd, s.get());
+            sessions_.push_back(std::move(s));
+        }
+    }
+
+    void readInput(Session& s) {
+        char buf[256];
+        for (;;) {
+            const ssize_t n = ::read(s.fd, buf, sizeof(buf));
+            if (n > 0) {
+                s.game->feedInput(buf, (std::size_t)n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || errno != EAGAIN) s.closed = true; // 客户端断开
+            return;
+        }
+    }
+
+    void tick() {
+        for (std::unique_ptr<Session>& s : sessions_) {
+            if (s->closed || (beat_ + s->phase) % s->every != 0) continue;
+            if (s->game->idle()) continue;
+            s->game->frame();
+            if (!s->game->running()) s->closed = true;
+        }
+    }
+
+    void reap() {
+        for (std::size_t i = 0; i < sessions_.size();) {
+            Session& s = *sessions_[i];
+            if (!s.closed) {
+                ++i;
+                continue;
+            }
+            epoll_ctl(epoll_, EPOLL_CTL_DEL, s.fd, nullptr);
+            s.game->end();
+            s.game.reset(); // 渲染器析构时给客户端送出恢复终端的控制序列
+            ::close(s.fd);
+            sessions_[i] = std::move(sessions_.back());
+            sessions_.pop_back();
+            count_--;
+        }
+    }
+
+    GameOptions options_;
+    int epoll_ = -1;
+    int wake_ = -1;
+    int timer_ = -1;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::size_t> count_{0};
+    std::mutex mutex_;
+    std::vector<Incoming> incoming_;
+    std::vector<std::unique_ptr<Session>> sessions_; // 只由本线程访问
+    std::uint64_t beat_ = 0;
+};
+
+ArcadeServer::ArcadeServer(const ArcadeOptions& options) : options_(options) {
+    // 各会话的种子互不相同；给了 --seed 时第 N 个会话用 seed + N，可以复现
+    baseSeed_ = options.game.seed != 0 ? options.game.seed : (std::uint32_t)std::time(nullptr) * 2654435761u;
+}
+
+ArcadeServer::~ArcadeServer() = default;
+
+int ArcadeServer::run() {
+    sockaddr_un addr;
+    if (!fillAddress(options_.socketPath, &addr)) {
+        std::fprintf(stderr, "%s: bad socket path\n", options_.socketPath.c_str());
+        return 1;
+    }
+    const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    // 路径上残留的旧套接字（上次没正常退出）可以删掉；还有服务器在听就不抢
+    if (connect(listener, (const sockaddr*)&addr, sizeof(addr)) == 0) {
+        std::fprintf(stderr, "%s: another server is listening\n", options_.socketPath.c_str());
+        ::close(listener);
+        return 1;
+    }
+    ::unlink(options_.socketPath.c_str());
+    if (bind(listener, (const sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 128) < 0) {
+        std::fprintf(stderr, "%s: %s\n", options_.socketPath.c_str(), std::strerror(errno));
+        ::close(listener);
+        return 1;
+    }
+
+    // 外形库与原型表在多线程运行前建好，之后各会话只读
+    archetypes();
+    internPrefabShapes();
+
+    // 客户端断开后写套接字不能杀掉整个进程；停止信号只交给接入线程（工作线程创建前屏蔽）
+    std::signal(SIGPIPE, SIG_IGN);
+    struct sigaction sa{};
+    sa.sa_handler = requestStop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    const int count = options_.workers > 0 ? options_.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+    const auto epoch = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) workers_.push_back(std::make_unique<Worker>(options_.game, epoch));
+    pthread_sigmask(SIG_UNBLOCK, &stopSignals, nullptr);
+    std::fprintf(stderr, "arcade: listening on %s with %d workers\n", options_.socketPath.c_str(), count);
+
+    bool acceptFailing = false; // 正在报告的 accept 错误：同一段连续出错只打印一次
+    while (!stopRequested) {
+        const int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EINTR（停止信号）或对端在接入前就断开：立即重试
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            // 其余（EMFILE、ENFILE、ENOBUFS……）一时不会好转，监听套接字仍然可读，
+            // 立即重试只会空转占满一个核：歇一会儿再试
+            if (!acceptFailing) std::fprintf(stderr, "arcade: accept failed: %s; retrying\n", std::strerror(errno));
+            acceptFailing = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (acceptFailing) std::fprintf(stderr, "arcade: accepting again\n");
+        acceptFailing = false;
+        // 交给会话最少的工作线程
+        Worker* target = workers_.front().get();
+        for (const std::unique_ptr<Worker>& w : workers_) {
+            if (w->sessions() < target->sessions()) target = w.get();
+        }
+        std::uint32_t seed = baseSeed_ + (std::uint32_t)served_;
+        if (seed == 0) seed = 1; // 0 表示按时间播种
+        target->adopt(fd, seed, served_++);
+    }
+
+    workers_.clear(); // 结束所有会话并等工作线程退出
+    ::close(listener);
+    ::unlink(options_.socketPath.c_str());
+    std::fprintf(stderr, "arcade: served %llu sessions\n", (unsigned long long)served_);
+    return 0;
+}
+
+#else
+
+ArcadeServer::ArcadeServer(const ArcadeOptions& options) : options_(options) {}
+
+ArcadeServer::~ArcadeServer() = default;
+
+class ArcadeServer::Worker {};
+
+int ArcadeServer::run() {
+    std::fprintf(stderr, "server mode needs Linux (epoll / timerfd)\n");
+    return 1;
+}
+
+#endif
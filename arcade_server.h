@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "game.h"
+
+struct ArcadeOptions {
+    std::string socketPath;
+    int workers = 0;  // 工作线程数；0 表示使用全部核心
+    GameOptions game; // 每个会话的选项（渲染固定为 ANSI，输出到客户端的套接字）
+};
+
+// 街机服务器：一个进程托管许多相互独立的 Game 会话，客户端（--connect）经 Unix 域套接字接入。
+// 会话按负载分到固定数量的工作线程上，每个会话只由它所在的线程驱动，会话之间不共享可变状态
+// （各自的 Rng 在运行期间绑定为线程的 gameRng()）。所有工作线程共用一个以服务器启动时刻为起点、
+// 60 Hz 的固定步长节拍（timerfd），30 Hz 的关卡模式会话每两拍运行一帧，并按会话编号错开，
+// 各拍的负载均匀。停在菜单 / 结束画面且没有新按键的会话不运行 frame()，只在 epoll 里等输入。
+class ArcadeServer {
+public:
+    explicit ArcadeServer(const ArcadeOptions& options);
+    ~ArcadeServer();
+    ArcadeServer(const ArcadeServer&) = delete;
+    ArcadeServer& operator=(const ArcadeServer&) = delete;
+
+    // 监听并接入客户端，直到收到 SIGINT / SIGTERM；无法监听时返回非 0
+    int run();
+
+private:
+    class Worker;
+
+    ArcadeOptions options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::uint32_t baseSeed_ = 0;
+    std::uint64_t served_ = 0;
+};
@@ -0,0 +1,495 @@
+#include "archetypes.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// 内置默认表，内容需与仓库中的 archetypes.txt 保持一致
+const char* const kDefaultArchetypes = R"(
+[player]
+color = green
+
+[pickup]
+color = blue
+
+[projectile shell]
+glyph_v = |
+glyph_h = -
+damage = 1
+speed = 2
+color = white
+intercepts = torpedo missile
+
+[projectile torpedo]
+glyph_v = =
+glyph_h = =
+damage = 10
+speed = 0.5
+erode = blast
+blast = 2
+color = white
+
+[projectile missile]
+glyph_v = *
+glyph_h = *
+damage = 5
+erode = cell
+blast = 1
+color = white
+
+[enemy gunboat]
+glyph = o
+hp = 1
+move = chase
+move_every = 8
+fire_every = 20
+shells = 10
+fire = aimed
+score = 0
+color = yellow
+
+[enemy destroyer]
+glyph = O
+hp = 10
+move = chase
+move_every = 12
+fire_every = 30
+shells = 10
+torpedoes = 2
+fire = aimed side_torpedoes
+score = 1
+chain = 1 10
+color = red
+
+[enemy cruiser]
+glyph = <>
+hp = 100
+move = strafe
+move_every = 15
+fire_every = 40
+shells = 30
+missiles = 2
+fire = cross tracking_missile
+score = 10
+chain = 2 30
+color = magenta
+
+[enemy bomber]
+glyph = \\\n==\n/
+glyph_left = /\n==\n\\
+hp = 9999
+move = fly
+move_every = 3
+fire_every = 25
+shells = 3
+torpedoes = 999
+fire = drop
+score = 0
+color = cyan
+invincible = 1
+phasing = 1
+
+[level 1]
+win_coins = 100
+start = bomber 4
+patrol = bomber 120
+wave_every = 50
+wave_size = 1
+wave = gunboat 50 top, destroyer 30 top, cruiser 15 left, bomber 5 edge
+pickup_chance = 200
+
+[level 2]
+win_coins = 200
+reset_coins = 1
+patrol = bomber 80
+wave_every = 30
+wave_size = 2
+wave = gunboat 20 top, destroyer 45 top, cruiser 30 sides, bomber 5 edge
+pickup_chance = 350
+)";
+
+std::string trim(const std::string& s) {
+    const auto b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    const auto e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// glyph 转义：\n 换行，\\ 反斜杠
+std::string unescapeGlyph(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            ++i;
+            out += (s[i] == 'n') ? '\n' : s[i];
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+bool parseColor(const std::string& v, std::uint8_t* out) {
+    static const char* const kNames[kColorCount] = {
+        "black", "red", "green", "yellow", "blue", "magenta", "cyan", "white"};
+    for (int i = 0; i < kColorCount; ++i) {
+        if (v == kNames[i]) {
+            *out = (std::uint8_t)(i + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseInt(const std::string& v, std::int32_t* out) {
+    std::istringstream ss(v);
+    long n = 0;
+    if (!(ss >> n) || !ss.eof()) return false;
+    *out = (std::int32_t)n;
+    return true;
+}
+
+// 格/帧，可以带小数，但必须是 1/kSpeedUnit 的整数倍
+bool parseSpeed(const std::string& v, std::uint8_t* out) {
+    std::istringstream ss(v);
+    double cells = 0;
+    if (!(ss >> cells) || !ss.eof()) return false;
+    const double units = cells * kSpeedUnit;
+    const long rounded = std::lround(units);
+    if (std::fabs(units - (double)rounded) > 1e-9 || rounded < 1 || rounded > kMaxProjectileSpeed * kSpeedUnit) return false;
+    *out = (std::uint8_t)rounded;
+    return true;
+}
+
+bool parseErode(const std::string& v, std::uint8_t* out) {
+    if (v == "none") *out = Erode::NONE;
+    else if (v == "cell") *out = Erode::CELL;
+    else if (v == "blast") *out = Erode::BLAST;
+    else return false;
+    return true;
+}
+
+bool parseRadius(const std::string& v, std::uint8_t* out) {
+    std::int32_t radius = 0;
+    if (!parseInt(v, &radius) || radius < 0 || radius > kMaxBlastRadius) return false;
+    *out = (std::uint8_t)radius;
+    return true;
+}
+
+// "<半径> <伤害>"，如 1 10
+bool parseChain(const std::string& v, std::uint8_t* radius, std::int32_t* damage) {
+    std::istringstream ss(v);
+    std::string r;
+    std::string d;
+    std::string rest;
+    if (!(ss >> r >> d) || (ss >> rest)) return false;
+    return parseRadius(r, radius) && parseInt(d, damage) && *damage >= 0;
+}
+
+bool parseFlag(const std::string& v, std::uint8_t* out) {
+    if (v != "0" && v != "1") return false;
+    *out = (std::uint8_t)(v == "1");
+    return true;
+}
+
+bool parseFire(const std::string& v, std::uint8_t* out) {
+    std::istringstream ss(v);
+    std::string word;
+    std::uint8_t bits = 0;
+    while (ss >> word) {
+        if (word == "aimed") bits |= FirePattern::AIMED;
+        else if (word == "side_torpedoes") bits |= FirePattern::SIDE_TORPEDOES;
+        else if (word == "cross") bits |= FirePattern::CROSS;
+        else if (word == "tracking_missile") bits |= FirePattern::TRACKING_MISSILE;
+        else if (word == "drop") bits |= FirePattern::DROP;
+        else if (word != "none") return false;
+    }
+    *out = bits;
+    return true;
+}
+
+bool parseMove(const std::string& v, MovePattern* out) {
+    if (v == "chase") *out = MovePattern::CHASE;
+    else if (v == "strafe") *out = MovePattern::STRAFE;
+    else if (v == "fly") *out = MovePattern::FLY;
+    else return false;
+    return true;
+}
+
+int projectileIndex(const std::string& name) {
+    if (name == "shell") return 0;
+    if (name == "torpedo") return 1;
+    if (name == "missile") return 2;
+    return -1;
+}
+
+bool parseIntercepts(const std::string& v, std::uint8_t* out) {
+    std::istringstream ss(v);
+    std::string word;
+    std::uint8_t bits = 0;
+    while (ss >> word) {
+        const int index = projectileIndex(word);
+        if (index >= 0) bits |= (std::uint8_t)(1 << index);
+        else if (word != "none") return false;
+    }
+    *out = bits;
+    return true;
+}
+
+bool parseEnemyName(const ArchetypeTable& t, const std::string& v, EnemyType* out) {
+    const int type = t.findEnemy(v);
+    if (type < 0) return false;
+    *out = (EnemyType)type;
+    return true;
+}
+
+// "<舰种> <数量或间隔>"，如 bomber 4
+bool parseEnemyCount(const ArchetypeTable& t, const std::string& v, EnemyType* type, std::int32_t* count) {
+    std::istringstream ss(v);
+    std::string name;
+    std::string number;
+    std::string rest;
+    if (!(ss >> name >> number) || (ss >> rest)) return false;
+    return parseEnemyName(t, name, type) && parseInt(number, count) && *count >= 0;
+}
+
+bool parseEnemyList(const ArchetypeTable& t, const std::string& v, std::vector<EnemyType>* out) {
+    std::istringstream ss(v);
+    std::string word;
+    out->clear();
+    while (ss >> word) {
+        if (word == "none") continue;
+        EnemyType type = 0;
+        if (!parseEnemyName(t, word, &type)) return false;
+        out->push_back(type);
+    }
+    return true;
+}
+
+bool parsePlace(const std::string& v, SpawnPlace* out) {
+    if (v == "top") *out = SpawnPlace::TOP;
+    else if (v == "left") *out = SpawnPlace::LEFT;
+    else if (v == "sides") *out = SpawnPlace::SIDES;
+    else if (v == "edge") *out = SpawnPlace::EDGE;
+    else return false;
+    return true;
+}
+
+// 逗号分隔的 "<舰种> <权重> <位置>"
+bool parseWave(const ArchetypeTable& t, const std::string& v, std::vector<WaveEntry>* out) {
+    std::istringstream list(v);
+    std::string item;
+    out->clear();
+    while (std::getline(list, item, ',')) {
+        std::istringstream ss(item);
+        std::string name;
+        std::string weight;
+        std::string place;
+        std::string rest;
+        if (!(ss >> name >> weight >> place) || (ss >> rest)) return false;
+        WaveEntry entry;
+        if (!parseEnemyName(t, name, &entry.type) || !parseInt(weight, &entry.weight) || entry.weight <= 0 ||
+            !parsePlace(place, &entry.place)) {
+            return false;
+        }
+        out->push_back(entry);
+    }
+    return true;
+}
+
+bool compile(std::istream& in, ArchetypeTable* table, std::string* error) {
+    ArchetypeTable t;
+    enum class Section { NONE, PLAYER, PICKUP, PROJECTILE, ENEMY, LEVEL } section = Section::NONE;
+    int index = -1;
+    std::string line;
+    int lineNo = 0;
+
+    auto fail = [&](const std::string& msg) {
+        if (error) *error = "line " + std::to_string(lineNo) + ": " + msg;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line.front() == '[') {
+            if (line.back() != ']') return fail("unterminated section header");
+            std::istringstream hs(line.substr(1, line.size() - 2));
+            std::string kind;
+            std::string name;
+            hs >> kind >> name;
+            if (kind == "player") {
+                section = Section::PLAYER;
+            } else if (kind == "pickup") {
+                section = Section::PICKUP;
+            } else if (kind == "projectile") {
+                section = Section::PROJECTILE;
+                index = projectileIndex(name);
+                if (index < 0) return fail("unknown projectile '" + name + "'");
+            } else if (kind == "enemy") {
+                if (name.empty()) return fail("enemy section needs a name");
+                if (t.findEnemy(name) >= 0) return fail("duplicate enemy '" + name + "'");
+                if (t.enemyCount() >= 255) return fail("too many enemy types");
+                section = Section::ENEMY;
+                index = t.enemyCount();
+                t.name.push_back(name);
+                t.glyphRight.push_back("?");
+                t.glyphLeft.push_back("");
+                t.hp.push_back(1);
+                t.moveInterval.push_back(10);
+                t.fireInterval.push_back(30);
+                t.shells.push_back(0);
+                t.torpedoes.push_back(0);
+                t.missiles.push_back(0);
+                t.score.push_back(0);
+                t.move.push_back(MovePattern::CHASE);
+                t.fire.push_back(0);
+                t.color.push_back(0);
+                t.invincible.push_back(0);
+                t.phasing.push_back(0);
+                t.chainRadius.push_back(0);
+                t.chainDamage.push_back(0);
+            } else if (kind == "level") {
+                // 关卡按出现顺序编号，引用的舰种需在前面定义
+                if (name != std::to_string(t.levels.size() + 1)) {
+                    return fail("expected [level " + std::to_string(t.levels.size() + 1) + "]");
+                }
+                section = Section::LEVEL;
+                index = (int)t.levels.size();
+                t.levels.push_back(LevelDef{});
+            } else {
+                return fail("unknown section '" + kind + "'");
+            }
+            continue;
+        }
+
+        const auto eq = line.find('=');
+        if (eq == std::string::npos) return fail("expected key = value");
+        const std::string key = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        bool ok = true;
+
+        switch (section) {
+            case Section::NONE:
+                return fail("key outside of a section");
+            case Section::PLAYER:
+            case Section::PICKUP:
+                if (key != "color") return fail("unknown key '" + key + "'");
+                ok = parseColor(value, section == Section::PLAYER ? &t.playerColor : &t.pickupColor);
+                break;
+            case Section::PROJECTILE:
+                if (key == "glyph_v") t.projectileGlyphV[index] = unescapeGlyph(value);
+                else if (key == "glyph_h") t.projectileGlyphH[index] = unescapeGlyph(value);
+                else if (key == "damage") ok = parseInt(value, &t.projectileDamage[index]);
+                else if (key == "color") ok = parseColor(value, &t.projectileColor[index]);
+                else if (key == "intercepts") ok = parseIntercepts(value, &t.projectileIntercepts[index]);
+                else if (key == "speed") ok = parseSpeed(value, &t.projectileSpeed[index]);
+                else if (key == "erode") ok = parseErode(value, &t.projectileErode[index]);
+                else if (key == "blast") ok = parseRadius(value, &t.projectileBlast[index]);
+                else return fail("unknown key '" + key + "'");
+                break;
+            case Section::ENEMY:
+                if (key == "glyph") t.glyphRight[index] = unescapeGlyph(value);
+                else if (key == "glyph_left") t.glyphLeft[index] = unescapeGlyph(value);
+                else if (key == "hp") ok = parseInt(value, &t.hp[index]);
+                else if (key == "move") ok = parseMove(value, &t.move[index]);
+                else if (key == "move_every") ok = parseInt(value, &t.moveInterval[index]);
+                else if (key == "fire_every") ok = parseInt(value, &t.fireInterval[index]);
+                else if (key == "shells") ok = parseInt(value, &t.shells[index]);
+                else if (key == "torpedoes") ok = parseInt(value, &t.torpedoes[index]);
+                else if (key == "missiles") ok = parseInt(value, &t.missiles[index]);
+                else if (key == "fire") ok = parseFire(value, &t.fire[index]);
+                else if (key == "score") ok = parseInt(value, &t.score[index]);
+                else if (key == "color") ok = parseColor(value, &t.color[index]);
+                else if (key == "invincible") ok = parseFlag(value, &t.invincible[index]);
+                else if (key == "phasing") ok = parseFlag(value, &t.phasing[index]);
+                else if (key == "chain") ok = parseChain(value, &t.chainRadius[index], &t.chainDamage[index]);
+                else return fail("unknown key '" + key + "'");
+                break;
+            case Section::LEVEL: {
+                LevelDef& level = t.levels[index];
+                if (key == "win_coins") ok = parseInt(value, &level.winCoins);
+                else if (key == "reset_coins") ok = parseFlag(value, &level.resetCoins);
+                else if (key == "clear") ok = parseEnemyList(t, value, &level.clear);
+                else if (key == "start") ok = parseEnemyCount(t, value, &level.startType, &level.startCount);
+                else if (key == "patrol") ok = parseEnemyCount(t, value, &level.patrolType, &level.patrolEvery);
+                else if (key == "wave_every") ok = parseInt(value, &level.waveEvery) && level.waveEvery >= 0;
+                else if (key == "wave_size") ok = parseInt(value, &level.waveSize) && level.waveSize >= 0;
+                else if (key == "wave") ok = parseWave(t, value, &level.wave);
+                else if (key == "pickup_chance") ok = parseInt(value, &level.pickupChance) && level.pickupChance > 0;
+                else return fail("unknown key '" + key + "'");
+                break;
+            }
+        }
+        if (!ok) return fail("bad value for '" + key + "': " + value);
+    }
+
+    for (int i = 0; i < ArchetypeTable::kProjectileTypes; ++i) {
+        t.projectileShapeV[i] = internShape(t.projectileGlyphV[i]);
+        t.projectileShapeH[i] = internShape(t.projectileGlyphH[i]);
+    }
+    for (int i = 0; i < t.enemyCount(); ++i) {
+        if (t.glyphLeft[i].empty()) t.glyphLeft[i] = t.glyphRight[i];
+        t.shapeRight.push_back(internShape(t.glyphRight[i]));
+        t.shapeLeft.push_back(internShape(t.glyphLeft[i]));
+        if (t.moveInterval[i] <= 0 || t.fireInterval[i] <= 0) {
+            if (error) *error = "enemy '" + t.name[i] + "': intervals must be positive";
+            return false;
+        }
+    }
+    if (t.enemyCount() == 0) {
+        if (error) *error = "no enemy types defined";
+        return false;
+    }
+    for (std::size_t i = 0; i < t.levels.size(); ++i) {
+        if (t.levels[i].waveEvery > 0 && t.levels[i].wave.empty()) {
+            if (error) *error = "level " + std::to_string(i + 1) + ": wave_every needs a wave list";
+            return false;
+        }
+    }
+    if (t.levels.empty()) {
+        if (error) *error = "no levels defined";
+        return false;
+    }
+
+    *table = std::move(t);
+    return true;
+}
+
+ArchetypeTable& mutableTable() {
+    static ArchetypeTable table = [] {
+        ArchetypeTable t;
+        std::istringstream in(kDefaultArchetypes);
+        compile(in, &t, nullptr);
+        return t;
+    }();
+    return table;
+}
+
+} // namespace
+
+int ArchetypeTable::findEnemy(const std::string& enemyName) const {
+    for (int i = 0; i < enemyCount(); ++i) {
+        if (name[i] == enemyName) return i;
+    }
+    return -1;
+}
+
+const ArchetypeTable& archetypes() {
+    return mutableTable();
+}
+
+bool loadArchetypes(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    ArchetypeTable t;
+    if (!compile(in, &t, error)) return false;
+    mutableTable() = std::move(t);
+    return true;
+}
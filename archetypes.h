@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "shapes.h"
+
+// 敌舰类型编号：archetypes.txt 中 [enemy ...] 段的出现顺序
+using EnemyType = std::uint8_t;
+
+enum class MovePattern : std::uint8_t {
+    CHASE,  // 随机游走，50% 概率朝玩家靠近
+    STRAFE, // 只左右移动
+    FLY     // 水平直飞，出界即消失
+};
+
+// 开火方式位掩码，可组合
+namespace FirePattern {
+enum : std::uint8_t {
+    AIMED = 1 << 0,
+    SIDE_TORPEDOES = 1 << 1,
+    CROSS = 1 << 2,
+    TRACKING_MISSILE = 1 << 3,
+    DROP = 1 << 4
+};
+}
+
+// 关卡刷怪的出生位置
+enum class SpawnPlace : std::uint8_t {
+    TOP,   // 顶边随机一列
+    LEFT,  // 左边随机一行
+    SIDES, // 左边或右边随机一行
+    EDGE   // 左右边缘的空位，朝场内飞（避开已有舰船与障碍，找不到空位就不刷）
+};
+
+struct WaveEntry {
+    EnemyType type = 0;
+    std::int32_t weight = 0;
+    SpawnPlace place = SpawnPlace::TOP;
+};
+
+// [level N] 段：一关的过关条件与刷怪节奏，由 Game 的关卡脚本按此运行
+struct LevelDef {
+    std::int32_t winCoins = 100;      // 金币达到此数过关（最后一关即通关）
+    std::uint8_t resetCoins = 0;      // 开局时金币清零
+    std::vector<EnemyType> clear;     // 过关还需全歼的舰种
+    EnemyType startType = 0;          // 开局随机放置 startCount 艘
+    std::int32_t startCount = 0;
+    EnemyType patrolType = 0;         // 每隔 patrolEvery 帧从边缘刷一艘（0 = 不刷）
+    std::int32_t patrolEvery = 0;
+    std::int32_t waveEvery = 0;       // 每隔 waveEvery 帧刷一波，每波 waveSize 艘，舰种按权重抽取
+    std::int32_t waveSize = 1;
+    std::vector<WaveEntry> wave;
+    std::int32_t pickupChance = 200;  // 每帧 1/pickupChance 的概率刷道具
+};
+
+// 投射物速度的定点单位：1 格/帧 = kSpeedUnit，可以表示 1/4 格/帧的慢速
+constexpr int kSpeedUnit = 4;
+constexpr int kMaxProjectileSpeed = 8; // 格/帧
+
+// 投射物撞上岛屿时削掉多少陆地
+namespace Erode {
+enum : std::uint8_t {
+    NONE,
+    CELL, // 撞上的那一格
+    BLAST // 撞上的那一格及周围 8 格
+};
+}
+
+// 爆炸半径上限（格）：半径 R 的爆炸波及上下 R 行、左右 2R 列（终端字符约 2:1 的高宽比）
+constexpr int kMaxBlastRadius = 4;
+
+// 颜色编号：0 为默认色，其余为 1 + 前景色（ANSI 0..7），Renderer 按此建立 color pair
+constexpr int kColorCount = 8;
+
+// 加载后编译出的扁平查找表（结构数组），按类型编号下标访问
+struct ArchetypeTable {
+    // 敌舰
+    std::vector<std::string> name;
+    std::vector<std::string> glyphRight;
+    std::vector<std::string> glyphLeft;
+    std::vector<ShapeId> shapeRight;
+    std::vector<ShapeId> shapeLeft;
+    std::vector<std::int32_t> hp;
+    std::vector<std::int32_t> moveInterval;
+    std::vector<std::int32_t> fireInterval;
+    std::vector<std::int32_t> shells;
+    std::vector<std::int32_t> torpedoes;
+    std::vector<std::int32_t> missiles;
+    std::vector<std::int32_t> score;
+    std::vector<MovePattern> move;
+    std::vector<std::uint8_t> fire;
+    std::vector<std::uint8_t> color;
+    std::vector<std::uint8_t> invincible;
+    std::vector<std::uint8_t> phasing;
+    std::vector<std::uint8_t> chainRadius;  // 被击毁时殉爆的半径，0 = 不殉爆
+    std::vector<std::int32_t> chainDamage;  // 殉爆中心的伤害
+
+    // 投射物：按 ProjectileType 下标
+    static constexpr int kProjectileTypes = 3;
+    std::string projectileGlyphV[kProjectileTypes];
+    std::string projectileGlyphH[kProjectileTypes];
+    ShapeId projectileShapeV[kProjectileTypes] = {};
+    ShapeId projectileShapeH[kProjectileTypes] = {};
+    std::int32_t projectileDamage[kProjectileTypes] = {};
+    std::uint8_t projectileColor[kProjectileTypes] = {};
+    std::uint8_t projectileIntercepts[kProjectileTypes] = {}; // 位 j：与第 j 类投射物相遇时双方一同销毁
+    std::uint8_t projectileSpeed[kProjectileTypes] = {kSpeedUnit, kSpeedUnit, kSpeedUnit}; // 每帧前进 speed / kSpeedUnit 格
+    std::uint8_t projectileErode[kProjectileTypes] = {}; // 撞上岛屿时削掉的范围，见 Erode
+    std::uint8_t projectileBlast[kProjectileTypes] = {}; // 命中或撞上障碍时的爆炸半径，0 = 只打中一艘
+
+    std::uint8_t playerColor = 0;
+    std::uint8_t pickupColor = 0;
+
+    // 关卡：按出现顺序依次进行
+    std::vector<LevelDef> levels;
+
+    int enemyCount() const { return (int)name.size(); }
+    // 按名字查找敌舰类型；找不到返回 -1
+    int findEnemy(const std::string& enemyName) const;
+};
+
+// 全局原型表。启动时调用 loadArchetypes；未调用或加载失败时使用内置默认表（与 archetypes.txt 相同）。
+const ArchetypeTable& archetypes();
+
+// 从文件加载原型表；失败时保留当前表并在 error 中给出原因
+bool loadArchetypes(const std::string& path, std::string* error);
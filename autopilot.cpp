@@ -0,0 +1,497 @@
+#include "autopilot.h"
+#include "archetypes.h"
+#include "prefabs.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+
+int projectileDamage(ProjectileType type) {
+    return archetypes().projectileDamage[(int)type];
+}
+
+int projectileSpeed(ProjectileType type) {
+    return archetypes().projectileSpeed[(int)type];
+}
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+} // namespace
+
+ThreatMap::ThreatMap() {
+    transient_.reserve(kMaxStamps);
+}
+
+void ThreatMap::reset(int rows, int cols) {
+    if (rows != rows_ || cols != cols_) {
+        rows_ = rows;
+        cols_ = cols;
+        danger_.assign((std::size_t)kHorizon * rows_ * cols_, 0);
+    } else {
+        // 尺寸没变（换关）：撤掉剩下的写入即可，不必整张清零
+        for (Track& track : tracks_) dropStamps(track);
+        for (const Stamp& s : transient_) remove(s);
+    }
+    tracks_.clear();
+    transient_.clear();
+}
+
+void ThreatMap::dropStamps(Track& track) {
+    for (; track.count > 0; --track.count) {
+        remove(track.stamps[track.first]);
+        track.first = (track.first + 1) % Track::kMaxStamps;
+    }
+}
+
+bool ThreatMap::tracked(EntityId id) const {
+    for (const Track& track : tracks_) {
+        if (track.id == id) return true;
+    }
+    return false;
+}
+
+void ThreatMap::terrainChanged(const World& world, const std::vector<CellChange>& changes) {
+    for (Track& track : tracks_) {
+        if (track.stale) continue;
+        const int top = std::min(track.originRow, track.row) - 1;
+        const int bottom = std::max(track.originRow, track.row) + 1;
+        const int left = std::min(track.originCol, track.col) - 1;
+        const int right = std::max(track.originCol, track.col) + 1;
+        for (const CellChange& change : changes) {
+            if (change.row >= top && change.row <= bottom && change.col >= left && change.col <= right) {
+                track.stale = true;
+                break;
+            }
+        }
+    }
+    terrain_ = world.terrainHash();
+}
+
+int ThreatMap::dangerAt(int row, int col) const {
+    if (row < 0 || row >= rows_ || col < 0 || col >= cols_) return 0;
+    // 第 now + t 帧到达的伤害按 (kHorizon + 1 - t) 加权：越早到越危险
+    const std::size_t cells = (std::size_t)rows_ * cols_;
+    const std::size_t idx = (std::size_t)row * cols_ + col;
+    int sum = 0;
+    for (int t = 1; t <= kHorizon; ++t) {
+        sum += danger_[(std::size_t)((now_ + t) % kHorizon) * cells + idx] * (kHorizon + 1 - t);
+    }
+    return sum;
+}
+
+void ThreatMap::add(int row, int col, std::uint32_t arrive, int amount, std::vector<Stamp>* log) {
+    const Stamp s{row * cols_ + col, arrive, amount};
+    layer(arrive)[s.idx] += amount;
+    log->push_back(s);
+}
+
+void ThreatMap::stampTrack(Track& track, int row, int col, std::uint32_t arrive) {
+    if (!nearPlayer(row, col)) return;
+    // 环中最多是 kHorizon 帧、每帧 kMaxProjectileSpeed 格的写入，不会溢出
+    Stamp& s = track.stamps[(track.first + track.count) % Track::kMaxStamps];
+    s = Stamp{row * cols_ + col, arrive, track.damage};
+    ++track.count;
+    layer(arrive)[s.idx] += s.amount;
+}
+
+void ThreatMap::extend(const World& world, Track& track) {
+    const std::uint32_t arrive = ++track.until;
+    if (track.stopped) return;
+    if (track.tracking) {
+        // 与 projectileSystem 一致：每帧朝目标修正一次方向，再走这一帧的步数
+        track.dRow = (std::int8_t)sign(track.targetRow - track.row);
+        track.dCol = (std::int8_t)sign(track.targetCol - track.col);
+    }
+    const int total = track.progress + track.speed;
+    track.progress = total % kSpeedUnit;
+    for (int step = total / kSpeedUnit; step > 0; --step) {
+        const int row = track.row + track.dRow;
+        const int col = track.col + track.dCol;
+        if (!world.inBounds(row, col) || world.isBlocked(row, col)) {
+            track.stopped = true; // 投射物撞到障碍即销毁
+            return;
+        }
+        track.row = row;
+        track.col = col;
+        stampTrack(track, row, col, arrive);
+    }
+}
+
+void ThreatMap::stampRay(const World& world, int row, int col, int dRow, int dCol, int t, int damage, int speed) {
+    if ((int)transient_.size() >= kMaxStamps) return;
+    if (t >= 1) {
+        if (world.isBlocked(row, col)) return;
+        if (nearPlayer(row, col)) add(row, col, now_ + t, damage, &transient_);
+    }
+    int progress = 0;
+    for (++t; t <= kHorizon; ++t) {
+        const int total = progress + speed;
+        progress = total % kSpeedUnit;
+        for (int step = total / kSpeedUnit; step > 0; --step) {
+            row += dRow;
+            col += dCol;
+            if (world.isBlocked(row, col)) return;
+            if (!nearPlayer(row, col)) continue;
+            if ((int)transient_.size() >= kMaxStamps) return;
+            add(row, col, now_ + t, damage, &transient_);
+        }
+    }
+}
+
+void ThreatMap::startTrack(const World& world, Track& track, const GameRegistry& reg, EntityId id) {
+    const Position& pos = *reg.get<Position>(id);
+    const Velocity& vel = *reg.get<Velocity>(id);
+    const ProjectileInfo& info = *reg.get<ProjectileInfo>(id);
+    track = Track{};
+    track.id = id;
+    track.originRow = track.row = pos.row;
+    track.originCol = track.col = pos.col;
+    track.dRow = (std::int8_t)vel.dRow;
+    track.dCol = (std::int8_t)vel.dCol;
+    track.tracking = info.type == ProjectileType::MISSILE && info.tracking;
+    track.targetRow = info.targetRow;
+    track.targetCol = info.targetCol;
+    track.progress = info.progress;
+    track.speed = projectileSpeed(info.type);
+    track.damage = projectileDamage(info.type);
+    track.until = now_;
+    if (info.fresh) {
+        // 本帧刚发射的还没动过：t=1 时仍在出生点
+        track.until = now_ + 1;
+        stampTrack(track, track.row, track.col, track.until);
+    }
+    while (track.until < now_ + kHorizon) extend(world, track);
+}
+
+void ThreatMap::update(const World& world, const GameRegistry& reg, EntityId player, std::uint32_t tick,
+                       const CollisionSystem& ships) {
+    // 地图尺寸变了、帧号不连续（换关、重开）、地形不是经 terrainChanged 变的（换了地图）：
+    // 之前的预测全部作废，重新接管范围内的投射物
+    const bool fresh = !started_ || world.rows() != rows_ || world.cols() != cols_ || tick != now_ + 1 ||
+                       world.terrainHash() != terrain_;
+    if (fresh) reset(world.rows(), world.cols());
+    started_ = true;
+    terrain_ = world.terrainHash();
+    now_ = tick;
+
+    const Position& playerPos = *reg.get<Position>(player);
+    playerRow_ = playerPos.row;
+    playerCol_ = playerPos.col;
+    // 投射物 kHorizon 帧内最多走 kHorizon × cells 格；每帧与玩家最多接近 cells + 1 格（玩家每帧走一格）
+    const ArchetypeTable& arch = archetypes();
+    int fastest = 1;
+    for (int type = 0; type < ArchetypeTable::kProjectileTypes; ++type) {
+        fastest = std::max(fastest, (arch.projectileSpeed[type] + kSpeedUnit - 1) / kSpeedUnit);
+    }
+    reach_ = kWindow + kHorizon * fastest;
+    band_ = fastest + 1;
+
+    // 撤销上一帧即将开火的敌舰的预测
+    for (const Stamp& s : transient_) remove(s);
+    transient_.clear();
+
+    // 已有的投射物：消失或飞出范围的撤掉剩下的预测，路径上地形变了的重新预测；
+    // 其余让到期的写入作废，再把预测补到 now + kHorizon。预测撞停的也留着，挡路的岛屿被炸开时要重做
+    for (std::size_t i = 0; i < tracks_.size();) {
+        Track& track = tracks_[i];
+        const bool alive = reg.alive(track.id);
+        const Position* pos = alive ? reg.get<Position>(track.id) : nullptr;
+        if (!pos || !inReach(pos->row, pos->col)) {
+            dropStamps(track);
+            track = tracks_.back();
+            tracks_.pop_back();
+            continue;
+        }
+        if (track.stale) {
+            dropStamps(track);
+            startTrack(world, track, reg, track.id);
+            ++i;
+            continue;
+        }
+        while (track.count > 0 && track.stamps[track.first].arrive <= now_) {
+            remove(track.stamps[track.first]);
+            track.first = (track.first + 1) % Track::kMaxStamps;
+            --track.count;
+        }
+        while (track.until < now_ + kHorizon) extend(world, track);
+        ++i;
+    }
+
+    // 接管范围内的新投射物。t=1 表示本帧移动后的位置；本帧玩家先移动、投射物后移动，所以当前位置不算危险
+    const ProjectileTable& shots = reg.table<ProjectileTable>();
+    const std::vector<Position>& pos = shots.column<Position>();
+    const std::vector<ProjectileInfo>& info = shots.column<ProjectileInfo>();
+    auto adopt = [&](EntityId id) {
+        growingPush(tracks_);
+        startTrack(world, tracks_.back(), reg, id);
+    };
+    if (fresh) {
+        // 刚接管：查一遍全表（只在换关、换地图时发生）
+        for (std::size_t r = 0; r < shots.size(); ++r) {
+            if (!shots.isDead(r) && inReach(pos[r].row, pos[r].col)) adopt(shots.id(r));
+        }
+    } else {
+        // 上一帧新发射的：表按发射先后排列，寿命为 0 的都在表尾
+        std::size_t begin = shots.size();
+        while (begin > 0 && info[begin - 1].lifeTime == 0) --begin;
+        for (std::size_t r = begin; r < shots.size(); ++r) {
+            if (!shots.isDead(r) && inReach(pos[r].row, pos[r].col)) adopt(shots.id(r));
+        }
+        // 从远处飞进范围的：上一帧还在范围外，这一帧只可能在最外 band_ 圈里
+        const int outer = reach_;
+        const int inner = reach_ - band_;
+        const int pr = playerRow_;
+        const int pc = playerCol_;
+        auto enter = [&](EntityId id) {
+            const Position& p = *reg.get<Position>(id);
+            if (inReach(p.row, p.col) && !tracked(id)) adopt(id);
+            return false;
+        };
+        ships.forEachShotIn(reg, pr - outer, pc - outer, pr - inner - 1, pc + outer, enter);
+        ships.forEachShotIn(reg, pr + inner + 1, pc - outer, pr + outer, pc + outer, enter);
+        ships.forEachShotIn(reg, pr - inner, pc - outer, pr + inner, pc - inner - 1, enter);
+        ships.forEachShotIn(reg, pr - inner, pc + inner + 1, pr + inner, pc + outer, enter);
+    }
+
+    // 即将开火的敌舰：按其开火节奏预测出生点与弹道（出生当帧就会判定碰撞）。
+    // 只在占格表上查窗口内的敌舰，每艘在它外形的第一格处理一次
+    sight_.beginTick(world, playerRow_, playerCol_);
+    const int pr = playerRow_;
+    const int pc = playerCol_;
+    ships.forEachShipIn(reg, pr - kWindow, pc - kWindow, pr + kWindow, pc + kWindow,
+                        [&](EntityId id, int row, int col) {
+        if (id == player) return false;
+        const Position& epos = *reg.get<Position>(id);
+        const ShapeCell& anchor = shapeOf(reg.get<Footprint>(id)->shape).cells.front();
+        if (epos.row + anchor.dr != row || epos.col + anchor.dc != col) return false;
+        if (!nearPlayer(epos.row, epos.col)) return false;
+        const AiTimers& timers = *reg.get<AiTimers>(id);
+        if (timers.nextFire == 0) return false; // 刚刷出、尚未登记
+        const int remaining = (int)(timers.nextFire - tick);
+        const int countdown = remaining < 1 ? 1 : remaining;
+        if (countdown > kHorizon) return false;
+        if (!sight_.seesTarget(epos.row, epos.col)) return false; // 看不到玩家的敌舰会压住火力
+
+        const Ammo& ammo = *reg.get<Ammo>(id);
+        const int er = epos.row;
+        const int ec = epos.col;
+        const int dr = sign(pr - er);
+        const int dc = sign(pc - ec);
+        const std::uint8_t pattern = arch.fire[reg.get<EnemyInfo>(id)->type];
+        const int shell = projectileDamage(ProjectileType::SHELL);
+        const int torpedo = projectileDamage(ProjectileType::TORPEDO);
+        const int shellSpeed = projectileSpeed(ProjectileType::SHELL);
+        const int torpedoSpeed = projectileSpeed(ProjectileType::TORPEDO);
+        if (pattern & FirePattern::AIMED) {
+            stampRay(world, er + dr, ec + dc, dr, dc, countdown, shell, shellSpeed);
+        }
+        if ((pattern & FirePattern::SIDE_TORPEDOES) && ammo.torpedoes > 0) {
+            stampRay(world, er, ec - 1, 0, -1, countdown, torpedo, torpedoSpeed);
+            stampRay(world, er, ec + 1, 0, 1, countdown, torpedo, torpedoSpeed);
+        }
+        if (pattern & FirePattern::CROSS) {
+            stampRay(world, er - 1, ec, -1, 0, countdown, shell, shellSpeed);
+            stampRay(world, er + 1, ec, 1, 0, countdown, shell, shellSpeed);
+            stampRay(world, er, ec - 1, 0, -1, countdown, shell, shellSpeed);
+            stampRay(world, er, ec + 1, 0, 1, countdown, shell, shellSpeed);
+        }
+        if (pattern & FirePattern::DROP) {
+            // 鱼雷或三连发二选一：按更危险的鱼雷估计正下方，两侧按炮弹估计
+            stampRay(world, er + 1, ec, 1, 0, countdown, torpedo, torpedoSpeed);
+            stampRay(world, er + 1, ec - 1, 1, -1, countdown, shell, shellSpeed);
+            stampRay(world, er + 1, ec + 1, 1, 1, countdown, shell, shellSpeed);
+        }
+        return false;
+    });
+}
+
+Autopilot::Autopilot() {}
+
+int Autopilot::traceShot(const World& world, const GameRegistry& reg, const CollisionSystem& ships, int row, int col,
+                         int dRow, int dCol, int range) const {
+    const ArchetypeTable& arch = archetypes();
+    for (int i = 0; i < range; ++i) {
+        if (world.isBlocked(row, col)) return 0;
+        // 这一格上第一艘值得开火的敌舰；无敌的（如 Bomber）不算，炮弹会从它身上穿过去找后面的
+        int kind = 0;
+        ships.forEachShipIn(reg, row, col, row, col, [&](EntityId id, int, int) {
+            const EnemyInfo* info = reg.get<EnemyInfo>(id);
+            if (!info || arch.invincible[info->type]) return false;
+            kind = info->type + 1;
+            return true;
+        });
+        if (kind != 0) return kind;
+        row += dRow;
+        col += dCol;
+    }
+    return 0;
+}
+
+namespace {
+
+// 以 (row, col) 为中心、切比雪夫半径 r 的一圈拆成至多四个矩形，依次交给 query(top, left, bottom, right)
+template <typename Query>
+void forEachRingRect(int row, int col, int r, Query&& query) {
+    if (r == 0) {
+        query(row, col, row, col);
+        return;
+    }
+    query(row - r, col - r, row - r, col + r);
+    query(row + r, col - r, row + r, col + r);
+    query(row - r + 1, col - r, row + r - 1, col - r);
+    query(row - r + 1, col + r, row + r - 1, col + r);
+}
+
+} // namespace
+
+bool Autopilot::findGoal(const GameRegistry& reg, const CollisionSystem& ships, int pr, int pc, bool needSupplies,
+                         int& goalRow, int& goalCol) const {
+    const ArchetypeTable& arch = archetypes();
+    int best = INT_MAX;
+    if (needSupplies) {
+        // 道具只占一格：第 r 圈之外的曼哈顿距离至少 r + 1
+        for (int r = 0; r <= kGoalRange && best > r; ++r) {
+            forEachRingRect(pr, pc, r, [&](int top, int left, int bottom, int right) {
+                ships.forEachPickupIn(reg, top, left, bottom, right, [&](EntityId, int row, int col) {
+                    const int d = std::abs(row - pr) + std::abs(col - pc);
+                    if (d < best) {
+                        best = d;
+                        goalRow = row;
+                        goalCol = col - 1;
+                    }
+                    return false;
+                });
+            });
+        }
+        return best != INT_MAX;
+    }
+
+    // 敌舰按 距离 - 8 × 金币 取最小；第 r 圈之外的敌舰，其位置（外形左上角）离玩家至少 r + 1 - 外形尺寸，
+    // 所以算上最高的金币与最大的外形，更外圈都不可能更好时提前停下
+    int bonus = 0;
+    int extent = 0;
+    for (int type = 0; type < arch.enemyCount(); ++type) {
+        if (arch.invincible[type]) continue;
+        bonus = std::max(bonus, 8 * arch.score[type]);
+        const Shape& right = shapeOf(arch.shapeRight[type]);
+        const Shape& left = shapeOf(arch.shapeLeft[type]);
+        extent = std::max({extent, right.height, right.width, left.height, left.width});
+    }
+    for (int r = 0; r <= kGoalRange && best >= r + 1 - extent - bonus; ++r) {
+        forEachRingRect(pr, pc, r, [&](int top, int left, int bottom, int right) {
+            ships.forEachShipIn(reg, top, left, bottom, right, [&](EntityId id, int, int) {
+                const EnemyInfo* info = reg.get<EnemyInfo>(id);
+                if (!info || arch.invincible[info->type]) return false;
+                const Position& e = *reg.get<Position>(id);
+                const int d = std::abs(e.row - pr) + std::abs(e.col - pc) - 8 * arch.score[info->type];
+                if (d < best) {
+                    best = d;
+                    goalRow = e.row + 6;
+                    goalCol = e.col - 1;
+                }
+                return false;
+            });
+        });
+    }
+    return best != INT_MAX;
+}
+
+InputState Autopilot::decide(const World& world, const GameRegistry& reg, EntityId player, std::uint32_t tick,
+                             const CollisionSystem& ships) {
+    threat_.update(world, reg, player, tick, ships);
+
+    const ArchetypeTable& arch = archetypes();
+    const Position& playerPos = *reg.get<Position>(player);
+    const Health& hp = *reg.get<Health>(player);
+    const Ammo& ammo = *reg.get<Ammo>(player);
+    const PlayerState& state = *reg.get<PlayerState>(player);
+    const ShapeId currentShape = reg.get<Footprint>(player)->shape;
+    const int pr = playerPos.row;
+    const int pc = playerPos.col;
+
+    // 目标点：残血或缺弹时去捡道具，否则去对准最值钱的敌舰（在其下方几格、同一列）
+    const bool needSupplies = hp.hp * 10 < hp.maxHp * 4 || ammo.shells < 10;
+    int goalRow = world.rows() - 3;
+    int goalCol = world.cols() / 2;
+    if (!(needSupplies && findGoal(reg, ships, pr, pc, true, goalRow, goalCol))) {
+        findGoal(reg, ships, pr, pc, false, goalRow, goalCol);
+    }
+    if (goalRow > world.rows() - 3) goalRow = world.rows() - 3;
+
+    // 候选动作：静止 + 四个方向，取 (危险度 * 权重 + 到目标距离) 最小者
+    static const int kMoves[5][2] = {{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    int bestScore = INT_MAX;
+    int moveRow = 0;
+    int moveCol = 0;
+    ShapeId chosenShape = currentShape;
+    for (const auto& m : kMoves) {
+        const ShapeId shapeId = (m[0] != 0) ? playerShape(true) : (m[1] != 0 ? playerShape(false) : currentShape);
+        const Shape& shape = shapeOf(shapeId);
+        const int nr = pr + m[0];
+        const int nc = pc + m[1];
+
+        bool placeable = true;
+        int danger = 0;
+        for (const ShapeCell& cell : shape.cells) {
+            if (world.isBlocked(nr + cell.dr, nc + cell.dc)) placeable = false;
+            danger += threat_.dangerAt(nr + cell.dr, nc + cell.dc);
+        }
+        if (!placeable) continue;
+
+        const int score = danger * 8 + std::abs(nr - goalRow) + std::abs(nc - goalCol);
+        if (score < bestScore) {
+            bestScore = score;
+            moveRow = m[0];
+            moveCol = m[1];
+            chosenShape = shapeId;
+        }
+    }
+
+    InputState input;
+    input.dRow = moveRow;
+    input.dCol = moveCol;
+
+    // 开火方向与 playerControlSystem 一致：移动方向优先，否则沿最后方向，再否则向上
+    int fr = (moveRow != 0 || moveCol != 0) ? moveRow : state.lastDirRow;
+    int fc = (moveRow != 0 || moveCol != 0) ? moveCol : state.lastDirCol;
+    if (fr == 0 && fc == 0) fr = -1;
+    const int shipRow = pr + moveRow;
+    const int shipCol = pc + moveCol;
+    const Shape& shape = shapeOf(chosenShape);
+
+    int muzzleRow = shipRow;
+    int muzzleCol = shipCol;
+    int bestFront = INT_MIN;
+    for (const ShapeCell& cell : shape.cells) {
+        const int s = cell.dr * fr + cell.dc * fc;
+        if (s > bestFront) {
+            bestFront = s;
+            muzzleRow = shipRow + cell.dr;
+            muzzleCol = shipCol + cell.dc;
+        }
+    }
+
+    const int forwardKind = traceShot(world, reg, ships, muzzleRow + fr, muzzleCol + fc, fr, fc, kFireRange);
+    input.fireShell = forwardKind != 0 && ammo.shells > 0;
+    // 导弹留给皮厚的目标（如 Cruiser）
+    input.fireMissile = ammo.missiles > 0 && forwardKind != 0 &&
+                        arch.hp[forwardKind - 1] >= 50 &&
+                        traceShot(world, reg, ships, muzzleRow + fr, muzzleCol + fc, fr, fc, kMissileRange) != 0;
+
+    // 侧舷三连发：从前三个占格向左/右各看一条射线
+    if (ammo.shells >= 13) {
+        auto sideHits = [&](int sr, int sc) {
+            int seen = 0;
+            for (const ShapeCell& cell : shape.cells) {
+                if (seen++ >= 3) break;
+                if (traceShot(world, reg, ships, shipRow + cell.dr + sr, shipCol + cell.dc + sc, sr, sc, kFireRange) != 0) return true;
+            }
+            return false;
+        };
+        input.fireSpreadLeft = sideHits(-fc, fr);
+        input.fireSpreadRight = !input.fireSpreadLeft && sideHits(fc, -fr);
+    }
+
+    return input;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "input_manager.h"
+#include "world.h"
+#include "components.h"
+#include "line_of_sight.h"
+#include "systems.h"
+
+// 危险度地图：每格记录“未来几帧内被命中的可能性”的加权值。
+// 飞行中的投射物轨迹是确定的（追踪导弹的目标在发射时就定了），所以每枚只在接管时预测一次，
+// 之后每帧只把预测往前补一帧、让到期的格子作废；投射物消失或飞远时撤掉它剩下的预测。
+// 只接管预测范围内路径可能进入窗口的投射物（离玩家不超过 reach_）：新发射的在表尾，
+// 从远处飞进来的一定落在范围边缘一圈，在碰撞系统的投射物分桶上只查这一圈。
+// 写入按预计到达的帧号分层存放，查询时按离现在的帧数加权，不需要每帧重写。
+// 地形变化只作废路径经过变化格子的预测。“即将开火的敌舰”依赖玩家当前的位置与视线，
+// 每帧撤销重算，且只看玩家附近窗口内的敌舰。
+// 每帧的代价与玩家附近的投射物、敌舰数量成正比，而不是与全图的投射物、敌舰或地图大小成正比。
+class ThreatMap {
+public:
+    static constexpr int kHorizon = 8;      // 预测未来多少帧
+    static constexpr int kMaxStamps = 4096; // 每帧最多为即将开火的敌舰写入多少格，超出后忽略更远的威胁
+    static constexpr int kWindow = kHorizon + 3; // 只关心玩家周围这么远的格子：更远的在预测范围内碰不到玩家
+
+    ThreatMap();
+
+    // tick：最近一次更新完成的帧号，用来把敌舰登记的开火帧换算成倒计时。
+    // ships：碰撞系统上一帧建好的舰船占格表，用来找窗口内的敌舰
+    void update(const World& world, const GameRegistry& reg, EntityId player, std::uint32_t tick,
+                const CollisionSystem& ships);
+    // 地形在帧中途变了：路径（含撞停的那一格）经过变化格子的预测在下次 update 时重做
+    void terrainChanged(const World& world, const std::vector<CellChange>& changes);
+
+    int dangerAt(int row, int col) const;
+
+private:
+    struct Stamp {
+        std::int32_t idx;
+        std::uint32_t arrive; // 预计到达的帧号
+        std::int32_t amount;
+    };
+
+    // 一枚飞行中投射物的预测：已经预测到第 until 帧，(row, col) 是那一帧的位置
+    struct Track {
+        static constexpr int kMaxStamps = kHorizon * kMaxProjectileSpeed;
+
+        EntityId id;
+        std::int32_t originRow = 0; // 接管时的位置：与 (row, col) 围成的矩形盖住预测的整条路径
+        std::int32_t originCol = 0;
+        std::int32_t row = 0;
+        std::int32_t col = 0;
+        std::int8_t dRow = 0;
+        std::int8_t dCol = 0;
+        bool tracking = false;
+        bool stopped = false; // 预测的路径撞上了障碍或出界
+        bool stale = false;   // 路径上的地形变了，需要从投射物的当前状态重新预测
+        std::int32_t targetRow = 0;
+        std::int32_t targetCol = 0;
+        std::int32_t progress = 0;
+        std::int32_t speed = 0;
+        std::int32_t damage = 0;
+        std::uint32_t until = 0;
+        // 尚未到达的写入，按到达帧号排列的环
+        Stamp stamps[kMaxStamps];
+        std::int32_t first = 0;
+        std::int32_t count = 0;
+    };
+
+    void reset(int rows, int cols);
+    // 按投射物的当前状态开始预测，补到 now + kHorizon
+    void startTrack(const World& world, Track& track, const GameRegistry& reg, EntityId id);
+    void dropStamps(Track& track);
+    bool tracked(EntityId id) const;
+    void add(int row, int col, std::uint32_t arrive, int amount, std::vector<Stamp>* log);
+    void remove(const Stamp& s) { layer(s.arrive)[s.idx] -= s.amount; }
+    std::int32_t* layer(std::uint32_t arrive) { return &danger_[(std::size_t)(arrive % kHorizon) * rows_ * cols_]; }
+    // 把 track 的预测往后推一帧，进入的格子落在窗口内就写入
+    void extend(const World& world, Track& track);
+    void stampTrack(Track& track, int row, int col, std::uint32_t arrive);
+    // (row, col) 是投射物在第 now + t 帧的位置（t 为 0 表示当前位置，不算危险），之后按 speed 逐帧前进；
+    // 写入记在 transient_，下一帧撤销
+    void stampRay(const World& world, int row, int col, int dRow, int dCol, int t, int damage, int speed);
+    bool nearPlayer(int row, int col) const {
+        return std::abs(row - playerRow_) <= kWindow && std::abs(col - playerCol_) <= kWindow;
+    }
+    bool inReach(int row, int col) const {
+        return std::abs(row - playerRow_) <= reach_ && std::abs(col - playerCol_) <= reach_;
+    }
+
+    int rows_ = 0;
+    int cols_ = 0;
+    std::uint32_t now_ = 0;
+    bool started_ = false;
+    std::uint64_t terrain_ = 0; // 做预测时的地形（World::terrainHash）
+    int playerRow_ = 0;
+    int playerCol_ = 0;
+    int reach_ = 0; // 预测范围内能进入窗口的投射物离玩家的最远距离（切比雪夫距离）
+    int band_ = 0;  // 每帧投射物与玩家最多接近这么多格：新进入 reach_ 的只会落在最外这几圈
+    std::vector<std::int32_t> danger_; // kHorizon 层，第 arrive % kHorizon 层是预计在 arrive 帧到达的伤害之和
+    std::vector<Track> tracks_;
+    std::vector<Stamp> transient_;     // 即将开火的敌舰的预测，下一帧撤销
+    LineOfSight sight_;
+};
+
+// 自动驾驶：代替 InputManager 产生每帧输入，用于演示、长时间运行测试与基准测试。
+class Autopilot {
+public:
+    static constexpr int kFireRange = 20;
+    static constexpr int kMissileRange = 15;
+
+    Autopilot();
+
+    // ships：碰撞系统上一帧的舰船占格表，查附近的敌舰用
+    InputState decide(const World& world, const GameRegistry& reg, EntityId player, std::uint32_t tick,
+                      const CollisionSystem& ships);
+    void terrainChanged(const World& world, const std::vector<CellChange>& changes) {
+        threat_.terrainChanged(world, changes);
+    }
+
+private:
+    static constexpr int kGoalRange = 48; // 找目标（道具、敌舰）时最远查这么多圈，更远的不去追
+
+    // 由近及远逐圈找目标点：残血或缺弹时找最近的道具，否则找最值钱的敌舰；都没有返回 false
+    bool findGoal(const GameRegistry& reg, const CollisionSystem& ships, int pr, int pc, bool needSupplies,
+                  int& goalRow, int& goalCol) const;
+    // 沿 (dRow, dCol) 方向查找射程内第一个可击毁的敌人，返回其类型编号 + 1（0 表示没有）
+    int traceShot(const World& world, const GameRegistry& reg, const CollisionSystem& ships, int row, int col,
+                  int dRow, int dCol, int range) const;
+
+    ThreatMap threat_;
+};
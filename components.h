@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include "ecs.h"
+#include "archetypes.h"
+#include "shapes.h"
+
+enum class ProjectileType {
+    SHELL,
+    TORPEDO,
+    MISSILE
+};
+
+// 投射物的发射方
+enum class Side : std::uint8_t {
+    PLAYER,
+    ENEMY
+};
+
+enum class PickupType {
+    WEAPON,
+    MEDICAL
+};
+
+// ---- 组件：只有数据，没有行为 ----
+
+struct Position {
+    int row = 0;
+    int col = 0;
+};
+
+// 外形（决定占格与绘制）
+struct Footprint {
+    ShapeId shape = 0;
+};
+
+struct Health {
+    int hp = 0;
+    int maxHp = 0;
+};
+
+struct Ammo {
+    int shells = 0;
+    int torpedoes = 0;
+    int missiles = 0;
+};
+
+// 下一次移动/开火的帧号（登记在时间轮上），0 表示尚未登记（远处的敌舰不登记开火）
+struct AiTimers {
+    std::uint32_t nextMove = 0;
+    std::uint32_t nextFire = 0;
+    int moveInterval = 0;
+    int fireInterval = 0;
+    int moveSteps = 1; // 下一次移动要走的步数：远处的敌舰隔几个间隔才动一次，一次补齐
+};
+
+struct Velocity {
+    int dRow = 0;
+    int dCol = 0;
+};
+
+struct Color {
+    int pair = 0; // 0 is default/white
+};
+
+struct EnemyInfo {
+    EnemyType type = 0;
+    int dir = 1; // 水平飞行方向（Bomber）：1 向右，-1 向左
+};
+
+struct ProjectileInfo {
+    ProjectileType type = ProjectileType::SHELL;
+    Side side = Side::ENEMY; // 发射方；拦截只发生在敌对双方的投射物之间
+    int lifeTime = 0;
+    // 导弹追踪
+    bool tracking = false;
+    int targetRow = 0;
+    int targetCol = 0;
+    // 本帧刚发射：不移动，只检查出生点（与发射方本帧的移动/开火顺序保持一致）
+    bool fresh = true;
+    // 本帧移动前所在的格子：本帧走过的格子是从这里沿速度方向的 steps 格，碰撞沿这些格子扫描
+    int prevRow = 0;
+    int prevCol = 0;
+    std::uint8_t progress = 0; // 速度的定点累计（见 kSpeedUnit），不足一格的部分留到下一帧
+    std::uint8_t steps = 0;    // 本帧走过的格数
+    bool blocked = false;      // 本帧途中撞上障碍或出界，停在前一格；碰撞扫描完走过的格子后销毁
+};
+
+struct PickupInfo {
+    PickupType type = PickupType::WEAPON;
+};
+
+struct PlayerState {
+    int coins = 0;
+    // 记录最后移动方向，用于发射子弹
+    int lastDirRow = -1; // 默认向上
+    int lastDirCol = 0;
+};
+
+// ---- 原型表：每种组件组合一张表 ----
+
+using PlayerTable = Table<Position, Footprint, Health, Ammo, Color, PlayerState>;
+using EnemyTable = Table<Position, Footprint, Health, Ammo, AiTimers, Color, EnemyInfo>;
+using ProjectileTable = Table<Position, Footprint, Velocity, Color, ProjectileInfo>;
+using PickupTable = Table<Position, Footprint, Color, PickupInfo>;
+
+// 表的顺序即绘制顺序：玩家、敌舰、投射物、道具
+using GameRegistry = Registry<PlayerTable, EnemyTable, ProjectileTable, PickupTable>;
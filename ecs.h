@@ -0,0 +1,295 @@
+#pragma once
+#include "alloc_tracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 实体句柄：index 指向 Registry 的槽位，generation 用来识别已被回收的旧句柄
+struct EntityId {
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+    std::uint32_t index = kInvalidIndex;
+    std::uint32_t generation = 0;
+
+    bool valid() const { return index != kInvalidIndex; }
+    bool operator==(const EntityId& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityId& other) const { return !(*this == other); }
+};
+
+// 一个原型（组件组合）对应一张表：每种组件一列连续数组，同一行是同一个实体。
+// 组件类型在一张表内不能重复。
+template <typename... Cs>
+class Table {
+public:
+    template <typename C>
+    static constexpr bool has() { return (std::is_same_v<C, Cs> || ...); }
+    template <typename... Qs>
+    static constexpr bool hasAll() { return (has<Qs>() && ...); }
+
+    std::size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+    EntityId id(std::size_t row) const { return ids_[row]; }
+
+    bool isDead(std::size_t row) const { return dead_[row] != 0; }
+    void markDead(std::size_t row) { dead_[row] = 1; }
+
+    template <typename C>
+    std::vector<C>& column() { return std::get<std::vector<C>>(columns_); }
+    template <typename C>
+    const std::vector<C>& column() const { return std::get<std::vector<C>>(columns_); }
+
+    std::size_t push(EntityId id, Cs... values) {
+        growingPush(ids_, id);
+        growingPush(dead_, 0);
+        (growingPush(column<Cs>(), std::move(values)), ...);
+        return ids_.size() - 1;
+    }
+
+    // 删除所有标记为死亡的行，保持其余行的相对顺序。
+    // onRemoved(id) 对每个被删除的实体调用，onMoved(id, newRow) 对每个换了行号的实体调用。
+    template <typename OnRemoved, typename OnMoved>
+    void compact(OnRemoved&& onRemoved, OnMoved&& onMoved) {
+        std::size_t out = 0;
+        const std::size_t n = ids_.size();
+        for (std::size_t in = 0; in < n; ++in) {
+            if (dead_[in]) {
+                onRemoved(ids_[in]);
+                continue;
+            }
+            if (out != in) {
+                ids_[out] = ids_[in];
+                dead_[out] = 0;
+                (moveRow<Cs>(in, out), ...);
+                onMoved(ids_[out], out);
+            }
+            ++out;
+        }
+        resize(out);
+    }
+
+    void clear() { resize(0); }
+
+    void reserve(std::size_t n) {
+        ids_.reserve(n);
+        dead_.reserve(n);
+        (column<Cs>().reserve(n), ...);
+    }
+
+private:
+    template <typename C>
+    void moveRow(std::size_t from, std::size_t to) {
+        auto& col = column<C>();
+        col[to] = std::move(col[from]);
+    }
+
+    void resize(std::size_t n) {
+        ids_.resize(n);
+        dead_.resize(n);
+        (column<Cs>().resize(n), ...);
+    }
+
+    std::vector<EntityId> ids_;
+    std::vector<std::uint8_t> dead_;
+    std::tuple<std::vector<Cs>...> columns_;
+};
+
+// 注册表：持有所有原型表，并把稳定的 EntityId 映射到 (表, 行)。
+// 系统通过 each<组件...>() 只遍历包含这些组件的表、只触碰用到的列。
+// 注意：遍历某张表时不要往同一张表里创建实体（列可能扩容）。
+template <typename... Tables>
+class Registry {
+public:
+    template <typename T>
+    T& table() { return std::get<T>(tables_); }
+    template <typename T>
+    const T& table() const { return std::get<T>(tables_); }
+
+    template <typename T, typename... Args>
+    EntityId create(Args&&... components) {
+        const EntityId id = allocate();
+        Slot& slot = slots_[id.index];
+        slot.table = (std::uint16_t)indexOf<T>();
+        slot.row = (std::uint32_t)table<T>().push(id, std::forward<Args>(components)...);
+        return id;
+    }
+
+    // 句柄仍指向一个存在（可能已标记死亡、尚未清理）的实体
+    bool contains(EntityId id) const {
+        return id.valid() && id.index < slots_.size() &&
+               slots_[id.index].live && slots_[id.index].generation == id.generation;
+    }
+
+    bool alive(EntityId id) const { return contains(id) && !isDead(id); }
+
+    // 实体在其原型表中的行号（需 contains(id)）；行号在 sweep() 之前保持不变
+    std::uint32_t rowOf(EntityId id) const { return slots_[id.index].row; }
+
+    bool isDead(EntityId id) const {
+        bool dead = true;
+        visit(id, [&](const auto& t, std::size_t row) { dead = t.isDead(row); });
+        return dead;
+    }
+
+    // 标记死亡；实际删除推迟到 sweep()，本帧内句柄与行号保持有效
+    void kill(EntityId id) {
+        visit(id, [&](auto& t, std::size_t row) { t.markDead(row); });
+    }
+
+    // 按句柄取组件；实体不存在或其原型不含该组件时返回 nullptr
+    template <typename C>
+    C* get(EntityId id) {
+        C* out = nullptr;
+        visit(id, [&](auto& t, std::size_t row) {
+            using T = std::decay_t<decltype(t)>;
+            if constexpr (T::template has<C>()) out = &t.template column<C>()[row];
+        });
+        return out;
+    }
+    template <typename C>
+    const C* get(EntityId id) const {
+        const C* out = nullptr;
+        visit(id, [&](const auto& t, std::size_t row) {
+            using T = std::decay_t<decltype(t)>;
+            if constexpr (T::template has<C>()) out = &t.template column<C>()[row];
+        });
+        return out;
+    }
+
+    template <typename... Cs, typename Fn>
+    void each(Fn&& fn) { eachImpl<Cs...>(*this, fn); }
+    template <typename... Cs, typename Fn>
+    void each(Fn&& fn) const { eachImpl<Cs...>(*this, fn); }
+
+    // 同 each，但回调额外收到实体句柄：fn(EntityId, Cs&...)
+    template <typename... Cs, typename Fn>
+    void eachWithId(Fn&& fn) { eachWithIdImpl<Cs...>(*this, fn); }
+    template <typename... Cs, typename Fn>
+    void eachWithId(Fn&& fn) const { eachWithIdImpl<Cs...>(*this, fn); }
+
+    // 删除所有已标记死亡的实体并回收句柄
+    void sweep() {
+        sweep([](EntityId) {});
+    }
+
+    // 同上；每个被删除的实体在回收句柄之前调用 onRemoved(id)
+    template <typename Fn>
+    void sweep(Fn&& onRemoved) {
+        forEachTable([&](auto& t, auto) {
+            t.compact([&](EntityId id) { onRemoved(id); release(id); },
+                      [&](EntityId id, std::size_t row) { slots_[id.index].row = (std::uint32_t)row; });
+        });
+    }
+
+    template <typename T>
+    void clearTable() {
+        T& t = table<T>();
+        for (std::size_t r = 0; r < t.size(); ++r) release(t.id(r));
+        t.clear();
+    }
+
+private:
+    struct Slot {
+        std::uint32_t generation = 0;
+        std::uint32_t row = 0;
+        std::uint16_t table = 0;
+        bool live = false;
+    };
+
+    template <typename T>
+    static constexpr std::size_t indexOf() {
+        constexpr bool matches[] = {std::is_same_v<T, Tables>...};
+        for (std::size_t i = 0; i < sizeof...(Tables); ++i) {
+            if (matches[i]) return i;
+        }
+        return sizeof...(Tables);
+    }
+
+    EntityId allocate() {
+        EntityId id;
+        if (!freeSlots_.empty()) {
+            id.index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            id.index = (std::uint32_t)slots_.size();
+            growingPush(slots_, Slot{});
+        }
+        Slot& slot = slots_[id.index];
+        slot.live = true;
+        id.generation = slot.generation;
+        return id;
+    }
+
+    void release(EntityId id) {
+        Slot& slot = slots_[id.index];
+        slot.live = false;
+        slot.generation++;
+        growingPush(freeSlots_, id.index);
+    }
+
+    template <typename Fn>
+    void forEachTable(Fn&& fn) { forEachTableImpl(*this, fn, std::index_sequence_for<Tables...>{}); }
+    template <typename Fn>
+    void forEachTable(Fn&& fn) const { forEachTableImpl(*this, fn, std::index_sequence_for<Tables...>{}); }
+
+    template <typename Self, typename Fn, std::size_t... Is>
+    static void forEachTableImpl(Self& self, Fn& fn, std::index_sequence<Is...>) {
+        (fn(std::get<Is>(self.tables_), std::integral_constant<std::size_t, Is>{}), ...);
+    }
+
+    // 找到句柄所在的表与行并回调 fn(表, 行)
+    template <typename Fn>
+    void visit(EntityId id, Fn&& fn) {
+        if (!contains(id)) return;
+        const Slot& slot = slots_[id.index];
+        forEachTable([&](auto& t, auto index) {
+            if (index == slot.table) fn(t, slot.row);
+        });
+    }
+    template <typename Fn>
+    void visit(EntityId id, Fn&& fn) const {
+        if (!contains(id)) return;
+        const Slot& slot = slots_[id.index];
+        forEachTable([&](const auto& t, auto index) {
+            if (index == slot.table) fn(t, slot.row);
+        });
+    }
+
+    template <typename... Cs, typename Self, typename Fn>
+    static void eachImpl(Self& self, Fn& fn) {
+        self.forEachTable([&](auto& t, auto) {
+            using T = std::decay_t<decltype(t)>;
+            if constexpr (T::template hasAll<Cs...>()) {
+                auto columns = std::make_tuple(t.template column<Cs>().data()...);
+                const std::size_t n = t.size();
+                for (std::size_t r = 0; r < n; ++r) {
+                    if (t.isDead(r)) continue;
+                    fn(std::get<decltype(t.template column<Cs>().data())>(columns)[r]...);
+                }
+            }
+        });
+    }
+
+    template <typename... Cs, typename Self, typename Fn>
+    static void eachWithIdImpl(Self& self, Fn& fn) {
+        self.forEachTable([&](auto& t, auto) {
+            using T = std::decay_t<decltype(t)>;
+            if constexpr (T::template hasAll<Cs...>()) {
+                auto columns = std::make_tuple(t.template column<Cs>().data()...);
+                const std::size_t n = t.size();
+                for (std::size_t r = 0; r < n; ++r) {
+                    if (t.isDead(r)) continue;
+                    fn(t.id(r), std::get<decltype(t.template column<Cs>().data())>(columns)[r]...);
+                }
+            }
+        });
+    }
+
+    std::tuple<Tables...> tables_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> freeSlots_;
+};
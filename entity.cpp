@@ -1,4 +0,0 @@
-#include "entity.h"
-
-Entity::Entity(int row, int col, std::string glyph) 
-    : row_(row), col_(col), glyph_(glyph) {}
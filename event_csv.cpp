@@ -0,0 +1,62 @@
+#include "event_csv.h"
+#include "archetypes.h"
+#include "event_log.h"
+#include <cstdio>
+
+namespace {
+
+const char* typeName(const EventRecord& e) {
+    static const char* const kProjectiles[ArchetypeTable::kProjectileTypes] = {"shell", "torpedo", "missile"};
+    static const char* const kPickups[] = {"weapon", "medical"};
+    switch (e.kind) {
+        case EventKind::LEVEL_START:
+            return e.type ? "survival" : "level";
+        case EventKind::ENEMY_HIT:
+        case EventKind::ENEMY_KILLED: {
+            const ArchetypeTable& arch = archetypes();
+            return e.type < arch.name.size() ? arch.name[e.type].c_str() : "?";
+        }
+        case EventKind::PLAYER_HIT:
+            return e.type < ArchetypeTable::kProjectileTypes ? kProjectiles[e.type] : "?";
+        case EventKind::PICKUP:
+            return e.type < 2 ? kPickups[e.type] : "?";
+        default:
+            return "";
+    }
+}
+
+} // namespace
+
+int runEventCsv(const std::string& path) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        std::perror(path.c_str());
+        return 1;
+    }
+    EventLogHeader header{};
+    if (std::fread(&header, sizeof(header), 1, in) != 1 || header.magic != kEventLogMagic ||
+        header.version != kEventLogVersion || header.recordSize != sizeof(EventRecord)) {
+        std::fprintf(stderr, "%s: not an event log (or a different version)\n", path.c_str());
+        std::fclose(in);
+        return 1;
+    }
+    const double tickRate = header.tickRate > 0 ? (double)header.tickRate : 1.0;
+
+    std::printf("tick,seconds,event,type,row,col,value,hp\n");
+    EventRecord batch[1024];
+    std::uint64_t records = 0;
+    std::size_t n = 0;
+    while ((n = std::fread(batch, sizeof(EventRecord), sizeof(batch) / sizeof(batch[0]), in)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const EventRecord& e = batch[i];
+            std::printf("%u,%.3f,%s,%s,%d,%d,%d,%d\n", e.tick, e.tick / tickRate, eventKindName(e.kind), typeName(e),
+                        e.row, e.col, e.value, e.hp);
+        }
+        records += n;
+    }
+    std::fclose(in);
+    std::fprintf(stderr, "%s: %llu events, %llu dropped, started at unix ms %llu, %u Hz\n", path.c_str(),
+                 (unsigned long long)records, (unsigned long long)header.dropped,
+                 (unsigned long long)header.startUnixMs, header.tickRate);
+    return 0;
+}
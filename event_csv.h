@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// 事件日志（--events）转 CSV：表头之后每条记录一行，写到标准输出；
+// 记录条数、丢弃数与开始时间写到 stderr。舰种名取自当前加载的原型表。返回进程退出码
+int runEventCsv(const std::string& path);
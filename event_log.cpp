@@ -0,0 +1,119 @@
+#include "event_log.h"
+#include "alloc_tracker.h"
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// 写满 size 字节；被信号打断就接着写
+bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        size -= (std::size_t)n;
+    }
+    return true;
+}
+
+} // namespace
+
+const char* eventKindName(EventKind kind) {
+    switch (kind) {
+        case EventKind::LEVEL_START: return "level_start";
+        case EventKind::ENEMY_HIT: return "enemy_hit";
+        case EventKind::ENEMY_KILLED: return "enemy_killed";
+        case EventKind::PLAYER_HIT: return "player_hit";
+        case EventKind::PICKUP: return "pickup";
+        case EventKind::PLAYER_DEATH: return "player_death";
+        case EventKind::WIN: return "win";
+        case EventKind::COUNT: break;
+    }
+    return "unknown";
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::open(const std::string& path, int tickRate) {
+    close();
+    const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: open: %s\n", path.c_str(), std::strerror(errno));
+        return false;
+    }
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const EventLogHeader header{kEventLogMagic, kEventLogVersion, (std::uint32_t)sizeof(EventRecord),
+                                (std::uint32_t)tickRate,
+                                (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(now).count(), 0};
+    if (!writeAll(fd, &header, sizeof(header))) {
+        std::fprintf(stderr, "%s: write: %s\n", path.c_str(), std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    path_ = path;
+    ring_.assign(kCapacity, EventRecord{});
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    stopping_ = false;
+    fd_ = fd;
+    writer_ = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+void EventLog::close() {
+    if (fd_ < 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+    flush(); // 写盘线程最后一次醒来之后游戏线程可能又写了几条
+
+    const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (::pwrite(fd_, &dropped, sizeof(dropped), offsetof(EventLogHeader, dropped)) != (ssize_t)sizeof(dropped)) {
+        std::fprintf(stderr, "%s: cannot record dropped count\n", path_.c_str());
+    }
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void EventLog::writerLoop() {
+    setAllocPhase(AllocPhase::BACKGROUND);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(kFlushMs), [this] { return stopping_; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+bool EventLog::flush() {
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) return true;
+
+    // 环上的一段最多分成两截连续的记录，各写一次
+    const std::size_t first = (std::size_t)(tail & (kCapacity - 1));
+    const std::size_t count = (std::size_t)(head - tail);
+    const std::size_t run = count < kCapacity - first ? count : kCapacity - first;
+    bool ok = writeAll(fd_, &ring_[first], run * sizeof(EventRecord));
+    if (ok && run < count) ok = writeAll(fd_, &ring_[0], (count - run) * sizeof(EventRecord));
+    if (!ok) dropped_.fetch_add(count, std::memory_order_relaxed); // 磁盘写不进去：记为丢弃，不堵住环
+    tail_.store(head, std::memory_order_release);
+    return ok;
+}
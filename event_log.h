@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 玩法事件日志：击毁、受伤、拾取道具、换关、阵亡、通关，每条一个定长的二进制记录。
+// 游戏线程把记录写进单生产者 / 单消费者的无锁环（只有一次拷贝和一次 release 存储，不加锁、不分配、
+// 不唤醒谁）；后台线程定期把环里攒下的记录成批写进日志文件。环满时丢弃新记录并计数，游戏线程从不等待。
+// 文件格式：EventLogHeader，其后是连续的 EventRecord（小端，本机字节序）。--events-csv 转成 CSV。
+
+enum class EventKind : std::uint8_t {
+    LEVEL_START,  // value：关卡号；type：1 = 生存模式
+    ENEMY_HIT,    // 敌舰受伤未沉；type：舰种；value：伤害；hp：剩余生命
+    ENEMY_KILLED, // type：舰种；value：得到的金币
+    PLAYER_HIT,   // type：投射物类型；value：伤害；hp：剩余生命
+    PICKUP,       // type：道具类型；hp：拾取后的生命
+    PLAYER_DEATH, // value：金币
+    WIN,          // value：金币
+    COUNT
+};
+
+const char* eventKindName(EventKind kind);
+
+struct EventRecord {
+    std::uint32_t tick;  // 游戏时间轮的帧号
+    EventKind kind;
+    std::uint8_t type;   // 含义见 EventKind
+    std::int16_t row;    // 发生的位置（地图坐标）
+    std::int16_t col;
+    std::int16_t hp;
+    std::int32_t value;
+};
+static_assert(sizeof(EventRecord) == 16, "event records are 16 bytes on disk");
+
+constexpr std::uint32_t kEventLogMagic = 0x474C5645; // "EVLG"
+constexpr std::uint32_t kEventLogVersion = 1;
+
+struct EventLogHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t tickRate;    // 逻辑帧率，换算成秒用
+    std::uint64_t startUnixMs; // 开始记录的墙钟时间
+    std::uint64_t dropped;     // 环满丢弃的记录数，关闭时写回
+};
+
+class EventLog {
+public:
+    static constexpr std::size_t kCapacity = 1 << 14; // 环的容量（条），2 的幂
+    static constexpr int kFlushMs = 20;               // 后台线程的写盘间隔
+
+    EventLog() = default;
+    ~EventLog();
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // 创建日志文件并启动写盘线程；失败时返回 false 并把原因写到 stderr
+    bool open(const std::string& path, int tickRate);
+    bool isOpen() const { return fd_ >= 0; }
+    // 写完环里剩下的记录，回写丢弃计数并关闭文件
+    void close();
+
+    // 之后的记录都打上这个帧号（游戏线程每帧设置一次）
+    void setTick(std::uint32_t tick) { tick_ = tick; }
+
+    // 只在游戏线程上调用；没打开时什么也不做
+    void record(EventKind kind, int type, int row, int col, int value, int hp = 0) {
+        if (fd_ < 0) return;
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring_[head & (kCapacity - 1)] = EventRecord{tick_, kind, (std::uint8_t)type, (std::int16_t)row,
+                                                     (std::int16_t)col, (std::int16_t)hp, value};
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void writerLoop();
+    bool flush(); // 把环里已发布的记录写进文件（写盘线程）
+
+    int fd_ = -1;
+    std::string path_;
+    std::vector<EventRecord> ring_;
+    std::uint32_t tick_ = 0;
+    // 各占一条缓存行，生产者与消费者不互相踩缓存行
+    alignas(64) std::atomic<std::uint64_t> head_{0}; // 游戏线程写
+    alignas(64) std::atomic<std::uint64_t> tail_{0}; // 写盘线程写
+    alignas(64) std::atomic<std::uint64_t> dropped_{0};
+
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable wake_; // 只在关闭时通知，平时按 kFlushMs 超时醒来
+    bool stopping_ = false;
+};
@@ -0,0 +1,99 @@
+#include "field_of_view.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 八个卦限的坐标变换：(dx, dy) → 列偏移 dx*xx + dy*xy，行偏移 dx*yx + dy*yy
+constexpr int kOctants[8][4] = {
+    {1, 0, 0, 1},   {0, 1, 1, 0},   {0, -1, 1, 0}, {-1, 0, 0, 1},
+    {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1},
+};
+
+} // namespace
+
+bool FieldOfView::update(const World& world, int row, int col) {
+    if (valid_ && row == originRow_ && col == originCol_) return false;
+
+    valid_ = true;
+    originRow_ = row;
+    originCol_ = col;
+    recomputes_++;
+    std::fill(lit_.begin(), lit_.end(), 0);
+
+    light(row, col);
+    for (const int* m : kOctants) {
+        castLight(world, 1, 1.0, 0.0, m[0], m[1], m[2], m[3]);
+    }
+    return true;
+}
+
+void FieldOfView::terrainChanged(const std::vector<CellChange>& changes) {
+    if (!valid_) return;
+    for (const CellChange& change : changes) {
+        if (std::abs(change.row - originRow_) <= kRadiusRows && std::abs(change.col - originCol_) <= kRadiusCols) {
+            valid_ = false;
+            return;
+        }
+    }
+}
+
+void FieldOfView::light(int row, int col) {
+    const int dr = row - originRow_;
+    const int dc = col - originCol_;
+    // 椭圆：(dr / Rr)^2 + (dc / Rc)^2 <= 1，Rc = 2 Rr
+    if (4 * dr * dr + dc * dc > kRadiusCols * kRadiusCols) return;
+    lit_[(dr + kRadiusCols) * kWindow + (dc + kRadiusCols)] = 1;
+}
+
+// 扫描第 depth 层起、斜率在 [endSlope, startSlope] 之间的扇区；遇到障碍时对障碍之前的
+// 未遮挡部分递归扫描下一层，本层继续寻找障碍之后的缺口
+void FieldOfView::castLight(const World& world, int depth, double startSlope, double endSlope,
+                            int xx, int xy, int yx, int yy) {
+    if (startSlope < endSlope) return;
+
+    double nextStart = startSlope;
+    for (int j = depth; j <= kRadiusCols; ++j) {
+        bool blocked = false;
+        for (int dx = -j, dy = -j; dx <= 0; ++dx) {
+            const double leftSlope = (dx - 0.5) / (dy + 0.5);
+            const double rightSlope = (dx + 0.5) / (dy - 0.5);
+            if (startSlope < rightSlope) continue;
+            if (endSlope > leftSlope) break;
+
+            const int col = originCol_ + dx * xx + dy * xy;
+            const int row = originRow_ + dx * yx + dy * yy;
+            light(row, col);
+
+            const bool wall = world.isBlocked(row, col); // 界外也算障碍
+            if (blocked) {
+                if (wall) {
+                    nextStart = rightSlope;
+                } else {
+                    blocked = false;
+                    startSlope = nextStart;
+                }
+            } else if (wall && j < kRadiusCols) {
+                blocked = true;
+                castLight(world, j + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                nextStart = rightSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+bool FieldOfView::visible(int row, int col) const {
+    if (!valid_) return false;
+    const int dr = row - originRow_;
+    const int dc = col - originCol_;
+    if (dr < -kRadiusCols || dr > kRadiusCols || dc < -kRadiusCols || dc > kRadiusCols) return false;
+    return lit_[(dr + kRadiusCols) * kWindow + (dc + kRadiusCols)] != 0;
+}
+
+bool FieldOfView::anyVisible(int row, int col, const Shape& shape) const {
+    for (const ShapeCell& cell : shape.cells) {
+        if (visible(row + cell.dr, col + cell.dc)) return true;
+    }
+    return false;
+}
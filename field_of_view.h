@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "shapes.h"
+#include "world.h"
+
+// 战争迷雾：玩家的视野。以视野中心为原点做递归阴影投射（recursive shadowcasting），
+// 八个卦限各扫一遍，被岛屿挡住的扇区不再向外扩展；障碍格本身可见。
+// 终端字符约为 2:1 的高宽比，视野按椭圆裁剪：横向半径是纵向的两倍。
+// 结果缓存在以中心为原点的小窗口里；只有中心移动或地形变化（invalidate）时才重算。
+class FieldOfView {
+public:
+    static constexpr int kRadiusRows = 10;
+    static constexpr int kRadiusCols = 2 * kRadiusRows;
+
+    // 中心不变且地形未变时直接沿用上次结果，返回 false；重算了返回 true
+    bool update(const World& world, int row, int col);
+
+    // 换关后调用，下一次 update 必定重算
+    void invalidate() { valid_ = false; }
+    // 部分格子变了（侵蚀、热重载）：只有变化落在当前视野窗口内才需要重算
+    void terrainChanged(const std::vector<CellChange>& changes);
+
+    bool visible(int row, int col) const;
+    // 外形左上角在 (row, col) 时是否有任意一格在视野内
+    bool anyVisible(int row, int col, const Shape& shape) const;
+
+    std::uint64_t recomputes() const { return recomputes_; }
+
+private:
+    static constexpr int kWindow = 2 * kRadiusCols + 1;
+
+    void castLight(const World& world, int depth, double startSlope, double endSlope,
+                   int xx, int xy, int yx, int yy);
+    void light(int row, int col);
+
+    bool valid_ = false;
+    int originRow_ = 0;
+    int originCol_ = 0;
+    std::uint64_t recomputes_ = 0;
+    std::vector<std::uint8_t> lit_ = std::vector<std::uint8_t>(kWindow * kWindow, 0);
+};
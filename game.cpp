@@ -1,122 +1,324 @@
 #include "game.h"
+#include "alloc_tracker.h"
+#include "prefabs.h"
+#include "rng.h"
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
-#include <sstream>
+#include <unistd.h>
+
+void FrameStats::record(double ms, double budgetMs, std::size_t enemies, std::size_t projectiles,
+                        std::size_t particles, const AllocCounts& allocated) {
+    ++frames;
+    allocs += allocated.count;
+    allocBytes += allocated.bytes;
+    if (allocated.count > 0) ++allocFrames;
+    if (allocated.count > maxFrameAllocs) maxFrameAllocs = allocated.count;
+    totalMs += ms;
+    if (ms > maxMs) maxMs = ms;
+    if (ms > budgetMs) ++overBudget;
+    if (enemies > peakEnemies) peakEnemies = enemies;
+    if (projectiles > peakProjectiles) peakProjectiles = projectiles;
+    if (particles > peakParticles) peakParticles = particles;
+    const int bucket = (int)(ms * 10.0);
+    histogram[bucket < kBuckets ? bucket : kBuckets - 1]++;
+}
 
-Game::Game(std::string mapFilePath)
-    : renderer_(World::kRows, World::kCols), mapFilePath_(std::move(mapFilePath)) {
-    std::srand(std::time(nullptr));
+double FrameStats::percentile(double p) const {
+    const std::uint64_t target = (std::uint64_t)(p * (double)frames);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += histogram[i];
+        if (seen > target) return (i + 1) / 10.0;
+    }
+    return maxMs;
+}
+
+Game::Game(const GameOptions& options)
+    : renderer_(makeRenderer(options.render, World::kDefaultRows, World::kDefaultCols, options.sessionFd)),
+      input_(options.render == RenderBackend::NCURSES, options.sessionFd >= 0 ? -1 : STDIN_FILENO),
+      useAutopilot_(options.autopilot),
+      survival_(options.survival),
+      bench_(options.bench),
+      maxFrames_(options.maxFrames),
+      overlay_(options.overlay),
+      allocCheck_(options.allocCheck),
+      tracing_(options.trace),
+      fog_(options.fog),
+      mapFilePath_(options.mapFilePath),
+      seed_(options.seed),
+      density_(options.density) {
+    GameRngScope bindRng(rng_);
+    gameRng().reseed(seed_ != 0 ? seed_ : (std::uint64_t)std::time(nullptr));
+    // 生存模式的刷怪脚本按名字引用原型；原型表中缺少时退回到第 0 种
+    auto typeOf = [](const char* name) {
+        const int id = archetypes().findEnemy(name);
+        return (EnemyType)(id < 0 ? 0 : id);
+    };
+    gunboatType_ = typeOf("gunboat");
+    destroyerType_ = typeOf("destroyer");
+    cruiserType_ = typeOf("cruiser");
+    bomberType_ = typeOf("bomber");
+    coinsCounter_ = scripts_.addCounter();
+    for (int type = 0; type < archetypes().enemyCount(); ++type) aliveCounters_.push_back(scripts_.addCounter());
+    // 预先登记道具等预制外形，免得第一次生成道具时才在游戏帧里分配
+    internPrefabShapes();
     // Player ship glyph is 3 rows tall; keep it fully in-bounds.
-    player_ = std::make_unique<PlayerShip>(World::kRows - 3, World::kCols / 2);
-    world_ = mapFilePath_.empty() ? World() : World(mapFilePath_);
-    startLevel(1);
+    player_ = spawnPlayer(registry_, World::kDefaultRows - 3, World::kDefaultCols / 2);
+    // 弹药自动回复：炮弹每 10 帧 +1，导弹每 1000 帧 +1
+    timers_.schedule(timers_.now() + kShellRegenInterval, TimerEvent{player_, 0, TimerKind::PLAYER_SHELL_REGEN});
+    timers_.schedule(timers_.now() + kMissileRegenInterval, TimerEvent{player_, 0, TimerKind::PLAYER_MISSILE_REGEN});
+    if (!mapFilePath_.empty()) mapWatcher_.watch(mapFilePath_);
+    if (!options.snapshotName.empty()) snapshots_.open(options.snapshotName);
+    if (!options.eventLogPath.empty() && events_.open(options.eventLogPath, tickRate())) collisions_.setEventLog(&events_);
+    if (survival_ && !bench_) loadHighScore(kHighScorePath, &best_);
+    newGame();
+}
+
+void Game::newGame() {
+    // 上一局的脚本全部作废；关卡模式由 campaignScript 逐关调用 startLevel
+    scripts_.clear();
+    levelScripts_.clear();
+    if (survival_) {
+        startLevel(1);
+    } else {
+        scripts_.start(campaignScript());
+    }
 }
 
 void Game::startLevel(int newLevel) {
     level_ = newLevel;
-    spawnTimer_ = 0;
+    levelEpoch_++;
+    for (ScriptId id : levelScripts_) scripts_.cancel(id);
+    levelScripts_.clear();
+    const LevelDef* level = survival_ ? nullptr : &archetypes().levels[level_ - 1];
 
-    // After clearing Level 1, reset coins for Level 2.
-    if (level_ == 2) {
-        player_->resetCoins();
-    }
+    PlayerState& player = *registry_.get<PlayerState>(player_);
+    if (level && level->resetCoins) player.coins = 0;
+    scripts_.set(coinsCounter_, player.coins);
 
     // Reset the arena state while keeping player's progress (HP/coins/ammo).
-    enemies_.clear();
-    projectiles_.clear();
-    pickups_.clear();
+    registry_.clearTable<EnemyTable>();
+    registry_.clearTable<ProjectileTable>();
+    registry_.clearTable<PickupTable>();
+    enemyAi_.clear();
+    for (ScriptScheduler::CounterId counter : aliveCounters_) scripts_.set(counter, 0);
+    // 地形：随机地图由后台提前生成（见 prepareNextLevel），这里只是移交；没准备过的（第一次开局）当场生成
+    startFitSize(level_, startFitHeight_, startFitWidth_);
     if (mapFilePath_.empty()) {
-        // Random map: regenerate per level.
-        world_ = World();
-    } else {
-        // File map: keep the same map across levels.
-        // (It is already loaded during Game construction / level 1 start.)
-        if (level_ == 1) {
-            world_ = World(mapFilePath_);
+        PreparedLevel prepared;
+        if (!preparer_.take(level_, prepared)) {
+            const int rows = survival_ ? kSurvivalRows : World::kDefaultRows;
+            const int cols = survival_ ? kSurvivalCols : World::kDefaultCols;
+            prepared = prepareLevel(level_, rows, cols, levelIslands(level_), startFitHeight_, startFitWidth_);
         }
+        world_ = std::move(prepared.world);
+        startFits_ = std::move(prepared.startFits);
+    } else {
+        // 地图文件：生存模式每局重新读取；关卡模式各关沿用同一张地图（第 1 关开始时读取）
+        if (survival_ || level_ == 1) world_ = World(mapFilePath_);
+        if (startFitHeight_ > 0) buildStartFits(world_, startFitHeight_, startFitWidth_, startFits_);
+    }
+    if (survival_) {
+        // 生存模式：一张大地图，摄像机跟随玩家
+        survivalStart_ = timers_.now();
+        recordSaved_ = false;
     }
 
-    // Reposition player to a safe, familiar spawn point.
-    player_->setPos(World::kRows - 3, World::kCols / 2);
-
-    // Level 1 starts with 4 Bombers placed randomly at distinct free positions.
-    if (level_ == 1) {
-        constexpr int kInitialBombers = 4;
-
-        std::vector<std::vector<bool>> occupied(World::kRows, std::vector<bool>(World::kCols, false));
-        auto canPlaceBomber = [&](int r, int c) {
-            // Bomber glyph is 3 rows tall and ~2 cols wide.
-            for (int dr = 0; dr < 3; ++dr) {
-                for (int dc = 0; dc < 2; ++dc) {
-                    int rr = r + dr;
-                    int cc = c + dc;
-                    if (!world_.inBounds(rr, cc)) return false;
-                    if (world_.isBlocked(rr, cc)) return false;
-                    if (occupied[rr][cc]) return false;
-                }
-            }
-            return true;
-        };
-        auto markBomber = [&](int r, int c) {
-            for (int dr = 0; dr < 3; ++dr) {
-                for (int dc = 0; dc < 2; ++dc) {
-                    occupied[r + dr][c + dc] = true;
-                }
-            }
-        };
+    fov_.invalidate();
+    // 特效的环形缓冲区到真正开局时才分配：菜单底下布置的那一关不需要
+    if (state_ == GameState::PLAYING) particles_.allocate();
+    particles_.clear();
 
-        int placed = 0;
-        const int maxAttempts = 5000;
-        for (int attempt = 0; attempt < maxAttempts && placed < kInitialBombers; ++attempt) {
-            int r = std::rand() % (World::kRows - 2); // 0..kRows-3
-            int c = 1 + (std::rand() % (World::kCols - 3)); // 1..kCols-3 (avoid instant wall hit)
+    // Reposition player to a safe, familiar spawn point.
+    *registry_.get<Position>(player_) = Position{world_.rows() - 3, world_.cols() / 2};
+    events_.setTick(timers_.now());
+    // 构造时在菜单底下预先布置的那一关不算开局
+    if (state_ == GameState::PLAYING)
+        events_.record(EventKind::LEVEL_START, survival_ ? 1 : 0, world_.rows() - 3, world_.cols() / 2, level_,
+                       registry_.get<Health>(player_)->hp);
+
+    // 开局舰船与刷怪脚本；脚本启动后立即运行到第一个 co_await，首次刷怪在若干帧之后
+    if (level) {
+        placeStartShips(*level);
+        pickupChance_ = level->pickupChance;
+        if (level->patrolEvery > 0) levelScripts_.push_back(scripts_.start(patrolScript(*level)));
+        if (level->waveEvery > 0) levelScripts_.push_back(scripts_.start(waveScript(*level)));
+    } else {
+        pickupChance_ = kSurvivalPickupChance;
+        levelScripts_.push_back(scripts_.start(survivalBomberScript()));
+        levelScripts_.push_back(scripts_.start(survivalWaveScript()));
+    }
 
-            if (!canPlaceBomber(r, c)) continue;
+    prepareNextLevel();
 
-            enemies_.push_back(std::make_unique<EnemyShip>(r, c, EnemyType::BOMBER));
-            markBomber(r, c);
-            placed++;
-        }
+    // 各表刚被清空重建，哈希整体重算
+    if (tracing_) {
+        stateHash_.rebuild(registry_);
+        settledEnemies_ = registry_.table<EnemyTable>().size();
+        settledPickups_ = registry_.table<PickupTable>().size();
     }
 }
 
 void Game::runLoop() {
-    running_ = true;
+    using Clock = std::chrono::steady_clock;
+    // 固定步长：按截止时间睡眠，而不是每帧固定睡 33ms，帧耗时不会累积成节奏漂移
+    const auto period = std::chrono::microseconds(1000000 / tickRate());
+    auto deadline = Clock::now();
+
+    begin();
+    std::uint64_t frames = 0;
     while (running_) {
-        InputState inputState = input_.poll();
-        
-        if (inputState.quit) {
-            running_ = false;
-            continue;
-        }
-        
-        if (state_ == GameState::MENU) {
-            handleMenuInput(inputState);
-            renderMenu();
-        } else if (state_ == GameState::PLAYING) {
-            handleInput(inputState);
-            update();
-            render();
-        } else if (state_ == GameState::GAME_OVER || state_ == GameState::WIN) {
-            renderer_.clear();
-            if (state_ == GameState::GAME_OVER) {
-                renderer_.printAt(World::kRows / 2, World::kCols / 2 - 10, "GAME OVER");
-            } else {
-                renderer_.printAt(World::kRows / 2, World::kCols / 2 - 10, "YOU WIN!");
+        if (maxFrames_ > 0 && frames++ >= maxFrames_) break;
+        frame();
+        if (!running_) break;
+
+        if (bench_) continue; // 基准模式不限速
+        deadline += period;
+        const auto now = Clock::now();
+        if (deadline < now) deadline = now; // 落后时不追帧，避免连续爆发
+        std::this_thread::sleep_until(deadline);
+    }
+    end();
+}
+
+void Game::begin() {
+    running_ = true;
+    for (int i = 0; i < kAllocPhases; ++i) phaseStart_[i] = allocCounts((AllocPhase)i);
+    if (tracing_ && maxFrames_ > 0) trace_.reserve(maxFrames_);
+}
+
+void Game::end() {
+    armAllocGuard(false);
+    for (int i = 0; i < kAllocPhases; ++i) {
+        const AllocCounts c = allocCounts((AllocPhase)i);
+        stats_.phaseAllocs[i] = AllocCounts{c.count - phaseStart_[i].count, c.bytes - phaseStart_[i].bytes};
+    }
+
+    // 中途退出（按 Q 或到达帧数上限）也算一局
+    if (survival_ && state_ == GameState::PLAYING) recordSurvival();
+}
+
+void Game::frame() {
+    using Clock = std::chrono::steady_clock;
+    GameRngScope bindRng(rng_);
+    const auto frameStart = Clock::now();
+    const AllocCounts allocStart = allocTotal();
+
+    // 分配检查：预热之后的游戏帧全程开着守卫，帧末再判断是否属于稳态帧
+    const bool guarded = allocCheck_ && state_ == GameState::PLAYING && playFrames_ >= kAllocWarmupFrames;
+    const std::uint32_t epochBefore = levelEpoch_;
+    const std::uint64_t reloadsBefore = mapReloads_;
+    if (guarded) armAllocGuard(true);
+
+    setAllocPhase(AllocPhase::INPUT);
+    InputState inputState = input_.poll();
+    setAllocPhase(AllocPhase::OTHER);
+    
+    if (inputState.quit) {
+        running_ = false;
+        return;
+    }
+    if (inputState.toggleOverlay) overlay_ = !overlay_;
+    
+    // 自动驾驶：跳过菜单，由 Autopilot 代替键盘产生操作（键盘仍可按 Q 退出）
+    if (useAutopilot_ && state_ == GameState::MENU) {
+        state_ = GameState::PLAYING;
+        newGame();
+    }
+    if (useAutopilot_ && state_ == GameState::PLAYING) {
+        setAllocPhase(AllocPhase::INPUT);
+        inputState = autopilot_.decide(world_, registry_, player_, timers_.now(), collisions_);
+        setAllocPhase(AllocPhase::OTHER);
+    }
+
+    if (state_ == GameState::MENU) {
+        handleMenuInput(inputState);
+        renderMenu();
+        drawnState_ = GameState::MENU;
+    } else if (state_ == GameState::PLAYING) {
+        drawnState_ = GameState::PLAYING;
+        setAllocPhase(AllocPhase::INPUT);
+        handleInput(inputState);
+        update();
+        if (tracing_) growingPush(trace_, stateHash());
+        if (snapshots_.isOpen()) publishSnapshot();
+        if (link_.due(playFrames_++)) render();
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        const AllocCounts allocEnd = allocTotal();
+        stats_.record(ms, 1000.0 / tickRate(), registry_.table<EnemyTable>().size(),
+                      registry_.table<ProjectileTable>().size(), particles_.live(),
+                      AllocCounts{allocEnd.count - allocStart.count, allocEnd.bytes - allocStart.bytes});
+
+        // 稳态帧：没有换关、没有热重载，这一局也没有结束。稳态帧里只允许已知增长点登记过的容器扩容
+        // （实体数创新高时摊还的正常增长），其余分配不论帧末是否仍在都算失败
+        if (guarded) {
+            armAllocGuard(false);
+            const AllocGuardSummary guard = allocGuardSummary();
+            const bool steady = levelEpoch_ == epochBefore && mapReloads_ == reloadsBefore && state_ == GameState::PLAYING;
+            if (steady && guard.unexpected > 0) {
+                allocFailure_ = true;
+                running_ = false;
+                std::fprintf(stderr, "alloc check: frame %llu (tick %u) allocated in steady state\n",
+                             (unsigned long long)playFrames_ - 1, timers_.now());
+                reportAllocGuard(STDERR_FILENO);
             }
-            renderer_.printAt(World::kRows / 2 + 2, World::kCols / 2 - 15, "Press Q to quit");
-            renderer_.present();
         }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(33)); // ~30 FPS
+    } else if (state_ == GameState::GAME_OVER || state_ == GameState::WIN) {
+        renderer_->clear();
+        if (state_ == GameState::GAME_OVER) {
+            renderer_->printAt(World::kDefaultRows / 2, World::kDefaultCols / 2 - 10, "GAME OVER");
+        } else {
+            renderer_->printAt(World::kDefaultRows / 2, World::kDefaultCols / 2 - 10, "YOU WIN!");
+        }
+        if (survival_) {
+            char survived[16];
+            char bestTime[16];
+            formatTicks(timers_.now() - survivalStart_, survived, sizeof(survived));
+            formatTicks(best_.ticks, bestTime, sizeof(bestTime));
+            char result[64];
+            char best[64];
+            std::snprintf(result, sizeof(result), "Survived %s  Score %d", survived,
+                          registry_.get<PlayerState>(player_)->coins);
+            std::snprintf(best, sizeof(best), "Best %s  Score %d", bestTime, best_.score);
+            renderer_->printAt(World::kDefaultRows / 2 - 4, World::kDefaultCols / 2 - 15, result);
+            renderer_->printAt(World::kDefaultRows / 2 - 3, World::kDefaultCols / 2 - 15, best);
+        }
+        renderer_->printAt(World::kDefaultRows / 2 + 2, World::kDefaultCols / 2 - 15, "Press Q to quit");
+        renderer_->present();
+        drawnState_ = state_;
     }
 }
 
+int Game::tickRate() const {
+    return survival_ ? kSurvivalTickRate : kLevelTickRate;
+}
+
+void Game::formatTicks(std::uint32_t ticks, char* out, std::size_t size) const {
+    const std::uint32_t seconds = ticks / (std::uint32_t)tickRate();
+    std::snprintf(out, size, "%u:%02u", seconds / 60, seconds % 60);
+}
+
+int Game::survivalSeconds() const {
+    return (int)((timers_.now() - survivalStart_) / (std::uint32_t)tickRate());
+}
+
+void Game::recordSurvival() {
+    if (recordSaved_ || bench_) return;
+    recordSaved_ = true;
+    const int score = registry_.get<PlayerState>(player_)->coins;
+    const std::uint32_t ticks = timers_.now() - survivalStart_;
+    bool improved = false;
+    if (score > best_.score) { best_.score = score; improved = true; }
+    if (ticks > best_.ticks) { best_.ticks = ticks; improved = true; }
+    if (improved) saveHighScore(kHighScorePath, best_);
+}
+
 void Game::handleInput(const InputState &input) {
-    player_->handleInput(input, world_);
+    playerControlSystem(registry_, player_, input, world_);
 }
 
 void Game::handleMenuInput(const InputState &input) {
@@ -130,7 +332,7 @@ void Game::handleMenuInput(const InputState &input) {
         if (menuSelection_ == 0) {
             // 开始游戏
             state_ = GameState::PLAYING;
-            startLevel(1);
+            newGame();
         } else if (menuSelection_ == 1) {
             // 退出游戏
             running_ = false;
@@ -139,308 +341,570 @@ void Game::handleMenuInput(const InputState &input) {
 }
 
 void Game::renderMenu() {
-    renderer_.clear();
+    renderer_->clear();
     
     // Draw title
-    int titleRow = World::kRows / 4;
-    renderer_.printAt(titleRow, World::kCols / 2 - 10, "===================");
-    renderer_.printAt(titleRow + 1, World::kCols / 2 - 10, "   SPACE SHOOTER   ");
-    renderer_.printAt(titleRow + 2, World::kCols / 2 - 10, "===================");
+    int titleRow = World::kDefaultRows / 4;
+    renderer_->printAt(titleRow, World::kDefaultCols / 2 - 10, "===================");
+    renderer_->printAt(titleRow + 1, World::kDefaultCols / 2 - 10, "   SPACE SHOOTER   ");
+    renderer_->printAt(titleRow + 2, World::kDefaultCols / 2 - 10, "===================");
     
     // Draw menu options
-    int menuRow = World::kRows / 2;
+    int menuRow = World::kDefaultRows / 2;
     std::string startText = menuSelection_ == 0 ? "> START GAME <" : "  START GAME  ";
     std::string quitText = menuSelection_ == 1 ? ">  QUIT GAME <" : "   QUIT GAME  ";
     
-    renderer_.printAt(menuRow, World::kCols / 2 - 7, startText);
-    renderer_.printAt(menuRow + 2, World::kCols / 2 - 7, quitText);
+    renderer_->printAt(menuRow, World::kDefaultCols / 2 - 7, startText);
+    renderer_->printAt(menuRow + 2, World::kDefaultCols / 2 - 7, quitText);
     
     // Draw instructions
-    renderer_.printAt(World::kRows - 3, World::kCols / 2 - 20, "Use Arrow Keys to select, SPACE to confirm");
+    renderer_->printAt(World::kDefaultRows - 3, World::kDefaultCols / 2 - 20, "Use Arrow Keys to select, SPACE to confirm");
     
-    renderer_.present();
+    renderer_->present();
+}
+
+void Game::reloadMap() {
+    // 只改动变化的格子；被新障碍埋住的实体挪开或移除
+    if (!world_.reloadFromFile(mapFilePath_)) return;
+    if (world_.dirty().empty()) return;
+    applyTerrainChanges();
+    mapReloads_++;
+    if (tracing_) stateHash_.rebuild(registry_); // 挪动/移除的实体不多，但散落各表，直接重算
 }
 
 void Game::update() {
-    auto canPlaceGlyphAt = [&](int baseRow, int baseCol, const std::string& glyph) -> bool {
-        std::stringstream ss(glyph);
-        std::string line;
-        int dr = 0;
-        while (std::getline(ss, line)) {
-            for (int dc = 0; dc < (int)line.size(); ++dc) {
-                if (line[dc] == ' ') continue;
-                const int rr = baseRow + dr;
-                const int cc = baseCol + dc;
-                if (!world_.inBounds(rr, cc)) return false;
-                if (world_.isBlocked(rr, cc)) return false;
-            }
-            ++dr;
+    if (mapWatcher_.changed()) reloadMap();
+
+    // 时间轮前进一帧，只取出本帧到期的事件
+    setAllocPhase(AllocPhase::TIMERS);
+    dueEvents_.clear();
+    timers_.advance(dueEvents_);
+    std::sort(dueEvents_.begin(), dueEvents_.end(), [](const TimerEvent& a, const TimerEvent& b) {
+        return a.kind < b.kind;
+    });
+
+    const std::uint32_t tick = timers_.now();
+    events_.setTick(tick);
+    for (const TimerEvent& ev : dueEvents_) {
+        switch (ev.kind) {
+            case TimerKind::PLAYER_SHELL_REGEN:
+                registry_.get<Ammo>(player_)->shells++;
+                timers_.schedule(tick + kShellRegenInterval, ev);
+                break;
+            case TimerKind::PLAYER_MISSILE_REGEN:
+                registry_.get<Ammo>(player_)->missiles++;
+                timers_.schedule(tick + kMissileRegenInterval, ev);
+                break;
+            case TimerKind::ENEMY_MOVE:
+            case TimerKind::ENEMY_FIRE:
+                break; // 交给 EnemyAiSystem
+            case TimerKind::SCRIPT:
+                break; // 不会出现在这个时间轮上
         }
-        return true;
-    };
+    }
 
-    spawnTimer_++;
-    spawnEnemies();
+    // 刷怪脚本的时间轮与 timers_ 同步前进，等到本帧的脚本在这里运行
+    setAllocPhase(AllocPhase::SPAWN);
+    scripts_.advance();
     spawnPickups();
     
-    player_->update();
+    setAllocPhase(AllocPhase::AI);
+    const Position playerPos = *registry_.get<Position>(player_);
+    sight_.beginTick(world_, playerPos.row, playerPos.col);
+    enemyAi_.run(registry_, timers_, dueEvents_, playerPos.row, playerPos.col, world_, sight_);
+    setAllocPhase(AllocPhase::PROJECTILES);
+    projectileSystem(registry_, world_);
+    setAllocPhase(AllocPhase::COLLISION);
+    collisions_.run(registry_, player_, world_);
+    erosionSystem(registry_, world_, collisions_.impacts());
+    applyTerrainChanges();
+    setAllocPhase(AllocPhase::EFFECTS);
+    particles_.update();
+    emitEffects();
     
-    for (auto& e : enemies_) {
-        const int prevRow = e->getRow();
-        const int prevCol = e->getCol();
-
-        e->aiUpdate(player_->getRow(), player_->getCol(), World::kRows, World::kCols);
-        e->update();
+    // Cleanup dead entities
+    setAllocPhase(AllocPhase::SWEEP);
+    auto countRemoved = [this](EntityId id) {
+        if (const EnemyInfo* info = registry_.get<EnemyInfo>(id)) scripts_.add(aliveCounters_[info->type], -1);
+    };
+    if (tracing_) {
+        hashTouched();
+        registry_.sweep([&](EntityId id) {
+            countRemoved(id);
+            stateHash_.remove(id);
+        });
+        settledEnemies_ = registry_.table<EnemyTable>().size();
+        settledPickups_ = registry_.table<PickupTable>().size();
+    } else {
+        registry_.sweep(countRemoved);
+    }
+    setAllocPhase(AllocPhase::OTHER);
 
-        // Entities (except Bomber) cannot move through obstacles.
-        if (e->getEnemyType() != EnemyType::BOMBER) {
-            if (!canPlaceGlyphAt(e->getRow(), e->getCol(), e->getGlyph())) {
-                e->setPos(prevRow, prevCol);
-            }
+    Health& playerHp = *registry_.get<Health>(player_);
+    if (playerHp.hp <= 0) {
+        if (bench_) {
+            // 基准模式：玩家不死，保证负载持续增长
+            playerHp.hp = playerHp.maxHp;
+        } else {
+            if (survival_) recordSurvival();
+            const Position& pos = *registry_.get<Position>(player_);
+            events_.record(EventKind::PLAYER_DEATH, 0, pos.row, pos.col, registry_.get<PlayerState>(player_)->coins);
+            state_ = GameState::GAME_OVER;
+            prepareNextLevel(); // 正在准备的下一关用不上了，改为准备新一局的第 1 关
+            return;
         }
     }
-    
-    for (auto& p : projectiles_) {
-        p->update();
-        if (!world_.inBounds(p->getRow(), p->getCol()) || world_.isBlocked(p->getRow(), p->getCol())) {
-            p->kill();
-        }
+
+    // 关卡推进：金币同步给脚本，条件满足的脚本（过关换关、通关）在这里恢复。
+    // 生存模式没有关卡目标，没有脚本在等计数器
+    scripts_.set(coinsCounter_, registry_.get<PlayerState>(player_)->coins);
+    scripts_.settle();
+}
+
+void Game::emitEffects() {
+    // 本帧被击毁的敌舰（热重载埋掉的敌舰生命值还在，不算）：在外形中心爆炸
+    const EnemyTable& enemies = registry_.table<EnemyTable>();
+    const std::vector<Position>& enemyPos = enemies.column<Position>();
+    const std::vector<Footprint>& enemyFp = enemies.column<Footprint>();
+    const std::vector<Health>& enemyHp = enemies.column<Health>();
+    for (std::size_t r = 0; r < enemies.size(); ++r) {
+        if (!enemies.isDead(r) || enemyHp[r].hp > 0) continue;
+        const Shape& shape = shapeOf(enemyFp[r].shape);
+        particles_.explode(enemyPos[r].row + shape.height / 2, enemyPos[r].col + shape.width / 2,
+                           (int)shape.cells.size());
     }
-    
-    collectProjectiles();
-    checkCollisions();
-    
-    // Cleanup dead entities
-    enemies_.erase(std::remove_if(enemies_.begin(), enemies_.end(), 
-        [](const auto& e) { return e->isDead(); }), enemies_.end());
-        
-    projectiles_.erase(std::remove_if(projectiles_.begin(), projectiles_.end(), 
-        [](const auto& p) { return p->isDead(); }), projectiles_.end());
-        
-    pickups_.erase(std::remove_if(pickups_.begin(), pickups_.end(), 
-        [](const auto& p) { return p->isDead(); }), pickups_.end());
-
-    if (player_->getHp() <= 0) {
-        state_ = GameState::GAME_OVER;
-        return;
+    // 鱼雷 / 导弹的爆炸与殉爆：火焰铺满爆炸半径
+    for (const CollisionSystem::Blast& blast : collisions_.blasts()) {
+        particles_.explode(blast.row, blast.col, 4 * blast.radius * blast.radius);
     }
 
-    // Level progression: reach the coin target to advance/win.
-    if (level_ == 1 && player_->getCoins() >= kLevel1WinCoins) {
-        startLevel(2);
-    } else if (level_ == 2 && player_->getCoins() >= kLevel2WinCoins) {
-        state_ = GameState::WIN;
-        // Should show win screen
+    // 投射物：发射当帧的炮口焰、鱼雷身后的航迹；本帧消失的（命中、被拦截、撞上障碍）溅出火花
+    const ProjectileTable& shots = registry_.table<ProjectileTable>();
+    const std::vector<Position>& pos = shots.column<Position>();
+    const std::vector<Velocity>& vel = shots.column<Velocity>();
+    const std::vector<ProjectileInfo>& info = shots.column<ProjectileInfo>();
+    for (std::size_t r = 0; r < shots.size(); ++r) {
+        if (shots.isDead(r)) {
+            particles_.spark(pos[r].row, pos[r].col);
+        } else if (info[r].lifeTime == 0) {
+            particles_.flash(pos[r].row, pos[r].col, vel[r].dRow, vel[r].dCol);
+        } else if (info[r].type == ProjectileType::TORPEDO && info[r].steps > 0) {
+            particles_.wake(info[r].prevRow, info[r].prevCol);
+        }
     }
 }
 
-void Game::spawnEnemies() {
-    auto trySpawnBomberAtEdge = [&]() {
-        std::vector<std::vector<bool>> occupied(World::kRows, std::vector<bool>(World::kCols, false));
+void Game::addEnemy(int row, int col, EnemyType type, int dir) {
+    enemyAi_.track(spawnEnemy(registry_, row, col, type, dir));
+    scripts_.add(aliveCounters_[type], 1);
+}
 
-        auto markGlyphArea = [&](int baseRow, int baseCol, const std::string& glyph) {
-            std::stringstream ss(glyph);
-            std::string line;
-            std::vector<std::string> lines;
-            int maxWidth = 0;
-            while (std::getline(ss, line)) {
-                if ((int)line.size() > maxWidth) maxWidth = (int)line.size();
-                lines.push_back(line);
-            }
+Encounter Game::campaignScript() {
+    const std::vector<LevelDef>& levels = archetypes().levels;
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        startLevel((int)i + 1);
+        co_await scripts_.atLeast(coinsCounter_, levels[i].winCoins);
+        for (EnemyType type : levels[i].clear) co_await scripts_.atMost(aliveCounters_[type], 0);
+    }
+    const Position& pos = *registry_.get<Position>(player_);
+    events_.record(EventKind::WIN, 0, pos.row, pos.col, registry_.get<PlayerState>(player_)->coins);
+    state_ = GameState::WIN;
+}
 
-            int h = (int)lines.size();
-            if (h <= 0) h = 1;
-            if (maxWidth <= 0) maxWidth = 1;
+Encounter Game::patrolScript(const LevelDef& level) {
+    for (;;) {
+        co_await scripts_.wait((std::uint32_t)level.patrolEvery);
+        spawnAtEdge(level.patrolType);
+    }
+}
 
-            for (int dr = 0; dr < h; ++dr) {
-                for (int dc = 0; dc < maxWidth; ++dc) {
-                    int rr = baseRow + dr;
-                    int cc = baseCol + dc;
-                    if (!world_.inBounds(rr, cc)) continue;
-                    occupied[rr][cc] = true;
+Encounter Game::waveScript(const LevelDef& level) {
+    int totalWeight = 0;
+    for (const WaveEntry& entry : level.wave) totalWeight += entry.weight;
+    for (;;) {
+        co_await scripts_.wait((std::uint32_t)level.waveEvery);
+        for (int i = 0; i < level.waveSize; ++i) {
+            int r = gameRng().below(totalWeight);
+            // 顶边的列无论抽中哪种位置都先取出来，随机数序列与舰种无关
+            const int col = gameRng().below(world_.cols());
+            const WaveEntry* pick = &level.wave.back();
+            for (const WaveEntry& entry : level.wave) {
+                if (r < entry.weight) {
+                    pick = &entry;
+                    break;
                 }
+                r -= entry.weight;
             }
-        };
+            switch (pick->place) {
+                case SpawnPlace::TOP:
+                    addEnemy(0, col, pick->type);
+                    break;
+                case SpawnPlace::LEFT:
+                    addEnemy(gameRng().below(world_.rows()), 0, pick->type);
+                    break;
+                case SpawnPlace::SIDES: {
+                    const int side = (gameRng().below(2) == 0) ? 0 : (world_.cols() - 1);
+                    addEnemy(gameRng().below(world_.rows()), side, pick->type);
+                    break;
+                }
+                case SpawnPlace::EDGE:
+                    spawnAtEdge(pick->type);
+                    break;
+            }
+        }
+    }
+}
+
+// 生存模式：强度随生存时间无上限增长——刷怪间隔缩短，每波数量线性增加，配比逐渐偏向更硬的舰种
+Encounter Game::survivalBomberScript() {
+    for (;;) {
+        co_await scripts_.wait((std::uint32_t)std::max(10, 120 - survivalSeconds() / 2));
+        spawnAroundPlayer(bomberType_);
+    }
+}
 
-        // Mark existing entities so we don't spawn Bomber overlapping them.
-        markGlyphArea(player_->getRow(), player_->getCol(), player_->getGlyph());
-        for (const auto& e : enemies_) {
-            if (e->isDead()) continue;
-            markGlyphArea(e->getRow(), e->getCol(), e->getGlyph());
+Encounter Game::survivalWaveScript() {
+    for (;;) {
+        co_await scripts_.wait((std::uint32_t)std::max(6, 60 - survivalSeconds() / 4));
+        const int seconds = survivalSeconds();
+        const int spawnCount = 1 + seconds / 15;
+        const int gunboatShare = std::max(20, 70 - seconds / 6);
+        const int cruiserShare = std::min(35, 5 + seconds / 12);
+        for (int i = 0; i < spawnCount; ++i) {
+            const int r = gameRng().below(100);
+            if (r < gunboatShare) {
+                spawnAroundPlayer(gunboatType_);
+            } else if (r < 95 - cruiserShare) {
+                spawnAroundPlayer(destroyerType_);
+            } else if (r < 95) {
+                spawnAroundPlayer(cruiserType_);
+            } else {
+                spawnAroundPlayer(bomberType_);
+            }
         }
+    }
+}
 
-        // Bomber is 3 rows tall and 2 cols wide.
-        auto canPlaceBomber = [&](int r, int c) {
-            for (int dr = 0; dr < 3; ++dr) {
-                for (int dc = 0; dc < 2; ++dc) {
-                    int rr = r + dr;
-                    int cc = c + dc;
-                    if (!world_.inBounds(rr, cc)) return false;
-                    if (world_.isBlocked(rr, cc)) return false;
-                    if (occupied[rr][cc]) return false;
-                }
+void Game::spawnAroundPlayer(EnemyType type) {
+    // 刷在玩家周围、视口之外的一圈里；刷怪点被障碍占住就换个位置，几次都不行就放弃这一只
+    const Position playerPos = *registry_.get<Position>(player_);
+    const ArchetypeTable& arch = archetypes();
+    const int halfRows = World::kDefaultRows / 2;
+    const int halfCols = World::kDefaultCols / 2;
+    const int rowLo = std::max(0, playerPos.row - halfRows - kSurvivalSpawnBand);
+    const int rowHi = std::min(world_.rows() - 1, playerPos.row + halfRows + kSurvivalSpawnBand);
+    const int colLo = std::max(0, playerPos.col - halfCols - kSurvivalSpawnBand);
+    const int colHi = std::min(world_.cols() - 1, playerPos.col + halfCols + kSurvivalSpawnBand);
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        const int row = rowLo + gameRng().below(rowHi - rowLo + 1);
+        const int col = colLo + gameRng().below(colHi - colLo + 1);
+        if (std::abs(row - playerPos.row) <= halfRows && std::abs(col - playerPos.col) <= halfCols) continue;
+        const int dir = col < playerPos.col ? 1 : -1; // 朝玩家一侧
+        const ShapeId shape = dir > 0 ? arch.shapeRight[type] : arch.shapeLeft[type];
+        if (!arch.phasing[type] && !canPlaceShape(world_, row, col, shapeOf(shape))) continue;
+        addEnemy(row, col, type, dir);
+        return;
+    }
+}
+
+void Game::spawnAtEdge(EnemyType type) {
+    // 占用格复用同一块缓冲区，地图尺寸不变就不再分配
+    const int cols = world_.cols();
+    occupied_.assign((std::size_t)world_.rows() * cols, 0);
+
+    auto markShapeArea = [&](const Position& pos, const Footprint& fp) {
+        const Shape& shape = shapeOf(fp.shape);
+        for (int dr = 0; dr < shape.height; ++dr) {
+            for (int dc = 0; dc < shape.width; ++dc) {
+                int rr = pos.row + dr;
+                int cc = pos.col + dc;
+                if (!world_.inBounds(rr, cc)) continue;
+                occupied_[(std::size_t)rr * cols + cc] = 1;
             }
-            return true;
-        };
-
-        const int maxAttempts = 200;
-        for (int attempt = 0; attempt < maxAttempts; ++attempt) {
-            int r = std::rand() % (World::kRows - 2); // 0..kRows-3
-            bool left = (std::rand() % 2 == 0);
-            int c = left ? 0 : (World::kCols - 2);
-            int dir = left ? 1 : -1; // Fly into the arena
-
-            if (!canPlaceBomber(r, c)) continue;
-            enemies_.push_back(std::make_unique<EnemyShip>(r, c, EnemyType::BOMBER, dir));
-            return;
         }
     };
 
-    // Extra Bomber spawns (post-start): higher frequency than before.
-    const int bomberInterval = (level_ == 1) ? 120 : 80;
-    if (spawnTimer_ % bomberInterval == 0) {
-        trySpawnBomberAtEdge();
-    }
+    // Mark existing ships (player and enemies) so we don't spawn overlapping them.
+    registry_.each<Position, Footprint, Health>([&](const Position& pos, const Footprint& fp, const Health&) {
+        markShapeArea(pos, fp);
+    });
+
+    // 按外形的包围盒检查（轰炸机 3 行 2 列）
+    const ArchetypeTable& arch = archetypes();
+    const Shape& right = shapeOf(arch.shapeRight[type]);
+    const Shape& left = shapeOf(arch.shapeLeft[type]);
+    const int height = std::max(right.height, left.height);
+    auto canPlace = [&](int r, int c, int width) {
+        const bool open = !world_.mayBeBlocked(r, c, height, width); // 金字塔上查不到障碍就只看占用格
+        for (int dr = 0; dr < height; ++dr) {
+            for (int dc = 0; dc < width; ++dc) {
+                int rr = r + dr;
+                int cc = c + dc;
+                if (!world_.inBounds(rr, cc)) return false;
+                if (!open && world_.isBlocked(rr, cc)) return false;
+                if (occupied_[(std::size_t)rr * cols + cc]) return false;
+            }
+        }
+        return true;
+    };
 
-    const int spawnInterval = (level_ == 1) ? 50 : 30;
-    if (spawnTimer_ % spawnInterval != 0) return;
+    const int maxAttempts = 200;
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        int r = gameRng().below(world_.rows() - height + 1);
+        bool fromLeft = (gameRng().below(2) == 0);
+        int width = fromLeft ? right.width : left.width;
+        int c = fromLeft ? 0 : (cols - width);
+        int dir = fromLeft ? 1 : -1; // Fly into the arena
 
-    const int spawnCount = (level_ == 1) ? 1 : 2;
-    for (int i = 0; i < spawnCount; ++i) {
-        int r = rand() % 100;
-        int col = rand() % World::kCols;
+        if (!canPlace(r, c, width)) continue;
+        addEnemy(r, c, type, dir);
+        return;
+    }
+}
 
-        if (level_ == 1) {
-            if (r < 50) {
-                enemies_.push_back(std::make_unique<EnemyShip>(0, col, EnemyType::GUNBOAT));
-            } else if (r < 80) {
-                enemies_.push_back(std::make_unique<EnemyShip>(0, col, EnemyType::DESTROYER));
-            } else if (r < 95) {
-                enemies_.push_back(std::make_unique<EnemyShip>(rand() % World::kRows, 0, EnemyType::CRUISER));
-            } else {
-                trySpawnBomberAtEdge();
+void Game::placeStartShips(const LevelDef& level) {
+    // 随机放在互不重叠的空位上（不贴左右边缘，免得一出生就撞墙）
+    if (level.startCount == 0) return;
+    const int cols = world_.cols();
+    const Shape& shape = shapeOf(archetypes().shapeRight[level.startType]);
+    occupied_.assign((std::size_t)world_.rows() * cols, 0);
+    // 地形一项查放置表（与地形一起提前建好），只有已放下的舰船要逐格检查
+    auto canPlace = [&](int r, int c) {
+        if (!startFits_[(std::size_t)r * cols + c]) return false;
+        for (int dr = 0; dr < shape.height; ++dr) {
+            for (int dc = 0; dc < shape.width; ++dc) {
+                if (occupied_[(std::size_t)(r + dr) * cols + c + dc]) return false;
             }
-        } else {
-            // Level 2 is harder: more enemies, more tough types.
-            if (r < 20) {
-                enemies_.push_back(std::make_unique<EnemyShip>(0, col, EnemyType::GUNBOAT));
-            } else if (r < 65) {
-                enemies_.push_back(std::make_unique<EnemyShip>(0, col, EnemyType::DESTROYER));
-            } else if (r < 95) {
-                int side = (rand() % 2 == 0) ? 0 : (World::kCols - 1);
-                enemies_.push_back(std::make_unique<EnemyShip>(rand() % World::kRows, side, EnemyType::CRUISER));
-            } else {
-                trySpawnBomberAtEdge();
+        }
+        return true;
+    };
+
+    int placed = 0;
+    const int maxAttempts = 5000;
+    for (int attempt = 0; attempt < maxAttempts && placed < level.startCount; ++attempt) {
+        int r = gameRng().below(world_.rows() - shape.height + 1);
+        int c = 1 + gameRng().below(cols - shape.width - 1);
+
+        if (!canPlace(r, c)) continue;
+
+        addEnemy(r, c, level.startType);
+        for (int dr = 0; dr < shape.height; ++dr) {
+            for (int dc = 0; dc < shape.width; ++dc) {
+                occupied_[(std::size_t)(r + dr) * cols + c + dc] = 1;
             }
         }
+        placed++;
     }
 }
 
 void Game::spawnPickups() {
-    const int pickupChance = (level_ == 1) ? 200 : 350;
-    if (rand() % pickupChance == 0) {
-        int r = rand() % World::kRows;
-        int c = rand() % World::kCols;
+    if (gameRng().below(pickupChance_) == 0) {
+        // 只刷在当前视口内（关卡模式下视口就是整张地图）
+        int camRow = 0;
+        int camCol = 0;
+        cameraOrigin(camRow, camCol);
+        int r = camRow + gameRng().below(std::min(world_.rows(), World::kDefaultRows));
+        int c = camCol + gameRng().below(std::min(world_.cols(), World::kDefaultCols));
         if (world_.isBlocked(r, c)) return;
-        if (rand() % 2 == 0)
-            pickups_.push_back(std::make_unique<Pickup>(r, c, PickupType::WEAPON));
+        if (gameRng().below(2) == 0)
+            spawnPickup(registry_, r, c, PickupType::WEAPON);
         else
-            pickups_.push_back(std::make_unique<Pickup>(r, c, PickupType::MEDICAL));
+            spawnPickup(registry_, r, c, PickupType::MEDICAL);
     }
 }
 
-void Game::collectProjectiles() {
-    auto newP = player_->collectNewProjectiles();
-    for (auto& p : newP) {
-        if (world_.isBlocked(p->getRow(), p->getCol())) p->kill();
-        projectiles_.push_back(std::move(p));
+void Game::applyTerrainChanges() {
+    const std::vector<CellChange>& changes = world_.dirty();
+    if (changes.empty()) return;
+    terrainChangedSystem(registry_, player_, world_, changes);
+    fov_.terrainChanged(changes);
+    if (useAutopilot_) autopilot_.terrainChanged(world_, changes);
+    if (!startFits_.empty()) updateStartFits(world_, startFitHeight_, startFitWidth_, startFits_, changes);
+    world_.clearDirty();
+}
+
+void Game::cameraOrigin(int& row, int& col) const {
+    // 视口以玩家为中心，贴住地图边缘
+    const Position& p = *registry_.get<Position>(player_);
+    row = std::max(0, std::min(p.row - World::kDefaultRows / 2, world_.rows() - World::kDefaultRows));
+    col = std::max(0, std::min(p.col - World::kDefaultCols / 2, world_.cols() - World::kDefaultCols));
+}
+
+void Game::hashTouched() {
+    const EnemyTable& enemies = registry_.table<EnemyTable>();
+    for (EntityId id : enemyAi_.touched()) {
+        if (registry_.contains(id)) stateHash_.refreshRow(enemies, registry_.rowOf(id));
     }
-    
-    for (auto& e : enemies_) {
-        auto newE = e->collectNewProjectiles();
-        for (auto& p : newE) {
-            if (world_.isBlocked(p->getRow(), p->getCol())) p->kill();
-            projectiles_.push_back(std::move(p));
-        }
+    for (EntityId id : collisions_.struck()) {
+        if (registry_.contains(id)) stateHash_.refreshRow(enemies, registry_.rowOf(id));
     }
+    stateHash_.refreshRows(enemies, settledEnemies_);
+    stateHash_.refreshRows(registry_.table<ProjectileTable>(), 0); // 投射物每帧都在移动
+    stateHash_.refreshRows(registry_.table<PickupTable>(), settledPickups_);
 }
 
-void Game::checkCollisions() {
-    auto hitsEntityGlyph = [&](const Entity& entity, int projRow, int projCol) -> bool {
-        const int baseRow = entity.getRow();
-        const int baseCol = entity.getCol();
-        const std::string& glyph = entity.getGlyph();
-
-        std::stringstream ss(glyph);
-        std::string line;
-        int dr = 0;
-        while (std::getline(ss, line)) {
-            for (int dc = 0; dc < (int)line.size(); ++dc) {
-                if (line[dc] == ' ') continue;
-                if (baseRow + dr == projRow && baseCol + dc == projCol) return true;
-            }
-            ++dr;
-        }
-        return false;
+void Game::publishSnapshot() {
+    // 直接写进共享内存的槽位，不经过中间缓冲
+    Snapshot& s = snapshots_.begin();
+    s.tick = timers_.now();
+    s.level = level_;
+    s.survival = survival_ ? 1 : 0;
+    s.state = (std::uint8_t)state_;
+    s.worldRows = (std::int16_t)world_.rows();
+    s.worldCols = (std::int16_t)world_.cols();
+    const Health& hp = *registry_.get<Health>(player_);
+    const Ammo& ammo = *registry_.get<Ammo>(player_);
+    s.hp = hp.hp;
+    s.maxHp = hp.maxHp;
+    s.coins = registry_.get<PlayerState>(player_)->coins;
+    s.shells = ammo.shells;
+    s.torpedoes = ammo.torpedoes;
+    s.missiles = ammo.missiles;
+
+    // 按列顺序直接读各表；写满容量后只累计没写下的数量
+    SnapshotEntity* out = s.entities;
+    std::uint32_t count = 0;
+    std::uint32_t dropped = 0;
+    auto room = [&](std::size_t rows) {
+        const std::size_t take = std::min(rows, (std::size_t)kSnapshotCapacity - count);
+        dropped += (std::uint32_t)(rows - take);
+        return take;
     };
-
-    // Projectile vs Ships
-    for (auto& p : projectiles_) {
-        if (p->isDead()) continue;
-        
-        // Vs Player
-        if (hitsEntityGlyph(*player_, p->getRow(), p->getCol())) {
-            player_->takeDamage(p->getDamage());
-            p->kill();
-            continue;
+    {
+        const PlayerTable& t = registry_.table<PlayerTable>();
+        const Position* pos = t.column<Position>().data();
+        const Health* health = t.column<Health>().data();
+        for (std::size_t r = 0, n = room(t.size()); r < n; ++r) {
+            out[count++] = SnapshotEntity{(std::int16_t)pos[r].row, (std::int16_t)pos[r].col,
+                                          (std::int16_t)health[r].hp, SnapshotKind::PLAYER, 0};
         }
-        
-        // Vs Enemies
-        for (auto& e : enemies_) {
-            if (e->isDead()) continue;
-            if (hitsEntityGlyph(*e, p->getRow(), p->getCol())) {
-                if (e->getEnemyType() != EnemyType::BOMBER) { // Bomber invincible
-                    e->takeDamage(p->getDamage());
-                    if (e->isDead()) {
-                        player_->addCoins(e->getScoreValue());
-                    }
-                }
-                p->kill();
-                break; 
-            }
+    }
+    {
+        const EnemyTable& t = registry_.table<EnemyTable>();
+        const Position* pos = t.column<Position>().data();
+        const Health* health = t.column<Health>().data();
+        const EnemyInfo* info = t.column<EnemyInfo>().data();
+        for (std::size_t r = 0, n = room(t.size()); r < n; ++r) {
+            out[count++] = SnapshotEntity{(std::int16_t)pos[r].row, (std::int16_t)pos[r].col,
+                                          (std::int16_t)health[r].hp, SnapshotKind::ENEMY, (std::uint8_t)info[r].type};
         }
     }
-    
-    // Player vs Pickups (Range +/- 1)
-    for (auto& pu : pickups_) {
-        if (pu->isDead()) continue;
-        if (abs(player_->getRow() - pu->getRow()) <= 1 && abs(player_->getCol() - pu->getCol()) <= 1) {
-            if (pu->getType() == PickupType::WEAPON) {
-                player_->addAmmo(20, 1);
-            } else {
-                player_->heal(100);
-            }
-            pu->kill();
+    {
+        const ProjectileTable& t = registry_.table<ProjectileTable>();
+        const Position* pos = t.column<Position>().data();
+        const ProjectileInfo* info = t.column<ProjectileInfo>().data();
+        for (std::size_t r = 0, n = room(t.size()); r < n; ++r) {
+            out[count++] = SnapshotEntity{(std::int16_t)pos[r].row, (std::int16_t)pos[r].col, 0,
+                                          SnapshotKind::PROJECTILE, (std::uint8_t)info[r].type};
         }
     }
+    {
+        const PickupTable& t = registry_.table<PickupTable>();
+        const Position* pos = t.column<Position>().data();
+        const PickupInfo* info = t.column<PickupInfo>().data();
+        for (std::size_t r = 0, n = room(t.size()); r < n; ++r) {
+            out[count++] = SnapshotEntity{(std::int16_t)pos[r].row, (std::int16_t)pos[r].col, 0,
+                                          SnapshotKind::PICKUP, (std::uint8_t)info[r].type};
+        }
+    }
+    s.count = count;
+    s.dropped = dropped;
+    snapshots_.commit();
+}
+
+std::uint64_t Game::stateHash() {
+    // 玩家每帧都可能变化（移动、弹药回复、基准模式回血），取值时顺带重算
+    stateHash_.refreshRows(registry_.table<PlayerTable>(), 0);
+    std::uint64_t h = stateHash_.entities();
+    h = hashCombine(h, world_.terrainHash());
+    h = hashCombine(h, rng_.state());
+    h = hashCombine(h, timers_.now());
+    h = hashCombine(h, (std::uint64_t)level_);
+    h = hashCombine(h, levelEpoch_);
+    return h;
+}
+
+IslandParams Game::levelIslands(int level) const {
+    IslandParams islands;
+    islands.seed = seed_ != 0 ? seed_ + (std::uint32_t)(level - 1) : gameRng().next();
+    islands.density = density_;
+    return islands;
+}
+
+void Game::startFitSize(int level, int& height, int& width) const {
+    height = 0;
+    width = 0;
+    if (survival_) return; // 生存模式没有开局舰船
+    const LevelDef& def = archetypes().levels[level - 1];
+    if (def.startCount == 0) return;
+    const Shape& shape = shapeOf(archetypes().shapeRight[def.startType]);
+    height = shape.height;
+    width = shape.width;
+}
+
+void Game::prepareNextLevel() {
+    // 只有随机地图需要生成；通关或阵亡之后回到第 1 关，生存模式的下一局也是第 1 关。
+    // 不在游戏中（构造时菜单底下布置的那一关、阵亡之后）下一次开局的也是第 1 关
+    if (!mapFilePath_.empty()) return;
+    const int count = survival_ ? 1 : (int)archetypes().levels.size();
+    const int next = state_ == GameState::PLAYING && level_ < count ? level_ + 1 : 1;
+    int fitHeight = 0;
+    int fitWidth = 0;
+    startFitSize(next, fitHeight, fitWidth);
+    const int rows = survival_ ? kSurvivalRows : World::kDefaultRows;
+    const int cols = survival_ ? kSurvivalCols : World::kDefaultCols;
+    preparer_.prepare(next, rows, cols, levelIslands(next), fitHeight, fitWidth);
 }
 
 void Game::render() {
-    renderer_.clear();
-    renderer_.drawBorders();
-    renderer_.drawWorld(world_);
-    
-    renderer_.drawEntity(*player_);
-    for (const auto& e : enemies_) renderer_.drawEntity(*e);
-    for (const auto& p : projectiles_) renderer_.drawEntity(*p);
-    for (const auto& pu : pickups_) renderer_.drawEntity(*pu);
+    const AllocPhase outer = setAllocPhase(AllocPhase::RENDER);
+    int camRow = 0;
+    int camCol = 0;
+    cameraOrigin(camRow, camCol);
+    renderer_->setCamera(camRow, camCol);
+
+    // 迷雾：以玩家外形的中心为视野原点，位置没变就沿用上一帧的视野
+    const FieldOfView* fog = nullptr;
+    if (fog_) {
+        const Position& pos = *registry_.get<Position>(player_);
+        const Shape& shape = shapeOf(registry_.get<Footprint>(player_)->shape);
+        fov_.update(world_, pos.row + shape.height / 2, pos.col + shape.width / 2);
+        fog = &fov_;
+    }
+
+    renderer_->setMonochrome(!link_.color());
+    renderer_->clear();
+    renderer_->drawBorders();
+    renderer_->drawWorld(world_, fog);
     
-    std::string hud = "Lv:" + std::to_string(level_) +
-                      " HP:" + std::to_string(player_->getHp()) + 
-                      " Coins:" + std::to_string(player_->getCoins()) + 
-                      " Shells:" + std::to_string(player_->getShells()) +
-                      " Missiles:" + std::to_string(player_->getMissiles());
-    renderer_.drawHud(hud);
+    renderSystem(registry_, *renderer_, fog);
+    particles_.draw(*renderer_); // 只画在空白海面上，等于垫在舰船与投射物下面
+    minimap_.draw(*renderer_, world_, registry_, player_, fog);
     
-    renderer_.present();
+    const Health& hp = *registry_.get<Health>(player_);
+    const Ammo& ammo = *registry_.get<Ammo>(player_);
+    // HUD 每帧都画，直接格式化到栈上的缓冲区，不产生堆分配
+    char hud[160];
+    if (survival_) {
+        char elapsed[16];
+        char bestTime[16];
+        formatTicks(timers_.now() - survivalStart_, elapsed, sizeof(elapsed));
+        formatTicks(best_.ticks, bestTime, sizeof(bestTime));
+        std::snprintf(hud, sizeof(hud), "T:%s Best:%s Score:%d/%d HP:%d S:%d M:%d Ships:%zu Shots:%zu", elapsed,
+                      bestTime, registry_.get<PlayerState>(player_)->coins, best_.score, hp.hp, ammo.shells,
+                      ammo.missiles, registry_.table<EnemyTable>().size(), registry_.table<ProjectileTable>().size());
+    } else {
+        std::snprintf(hud, sizeof(hud), "Lv:%d HP:%d Coins:%d Shells:%d Missiles:%d", level_, hp.hp,
+                      registry_.get<PlayerState>(player_)->coins, ammo.shells, ammo.missiles);
+    }
+    renderer_->drawHud(hud);
+    if (overlay_) {
+        char overlay[128];
+        link_.describe(overlay, sizeof(overlay));
+        renderer_->drawOverlay(overlay);
+    }
+
+    renderer_->present();
+    link_.record(renderer_->lastPresent(), 1000.0 / tickRate());
+    setAllocPhase(outer);
 }
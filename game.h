@@ -5,10 +5,22 @@
 #include "world.h"
 #include "renderer.h"
 #include "input_manager.h"
-#include "player_ship.h"
-#include "enemy_ship.h"
-#include "projectile.h"
-#include "pickup.h"
+#include "components.h"
+#include "systems.h"
+#include "autopilot.h"
+#include "highscore.h"
+#include "map_watcher.h"
+#include "field_of_view.h"
+#include "state_hash.h"
+#include "link_adapter.h"
+#include "alloc_tracker.h"
+#include "script_scheduler.h"
+#include "rng.h"
+#include "level_preparer.h"
+#include "snapshot_ring.h"
+#include "particles.h"
+#include "minimap.h"
+#include "event_log.h"
 
 enum class GameState {
     MENU,
@@ -17,11 +29,75 @@ enum class GameState {
     WIN
 };
 
+struct GameOptions {
+    std::string mapFilePath;
+    bool autopilot = false;
+    bool survival = false; // 无尽生存模式
+    bool bench = false;    // 基准：不限速、玩家不死，结束时输出帧耗时统计
+    bool fog = false;      // 战争迷雾：只显示玩家视野内的敌舰
+    bool overlay = false;  // 调试浮层：显示输出自适应的档位与链路吞吐（游戏中按 I 开关）
+    RenderBackend render = RenderBackend::NCURSES;
+    std::uint64_t maxFrames = 0; // >0 时运行这么多帧后退出（配合内存后端做无终端运行）
+    std::uint32_t seed = 0;      // 随机地图的种子；0 表示每次随机，否则第 N 关用 seed + N - 1
+    int density = IslandParams{}.density; // 随机地图初始陆地比例（%）
+    bool trace = false;          // 每帧记录一次状态哈希（见 Game::trace），用于金标准轨迹比对
+    bool allocCheck = false;     // 预热后的稳态帧里出现堆分配即报告调用栈并停止（见 Game::allocFailed）
+    int sessionFd = -1;          // 服务器会话：画面写到这个套接字，按键由服务器经 feedInput 转交；-1 用本进程的终端
+    std::string snapshotName;    // 非空时每个逻辑帧把状态快照发布到这个名字的共享内存（见 snapshot_ring.h）
+    std::string eventLogPath;    // 非空时把玩法事件写进这个二进制日志（见 event_log.h）
+};
+
+// 游戏进行中每帧（输入 + 更新 + 绘制）的耗时统计
+struct FrameStats {
+    static constexpr int kBuckets = 1000; // 0.1ms 一档，最后一档收纳所有更慢的帧
+    std::uint64_t frames = 0;
+    std::uint64_t overBudget = 0; // 超出一帧时间预算的帧数
+    double totalMs = 0;
+    double maxMs = 0;
+    std::size_t peakEnemies = 0;
+    std::size_t peakProjectiles = 0;
+    std::size_t peakParticles = 0;
+    std::uint32_t histogram[kBuckets] = {};
+
+    // 堆分配：游戏帧内的总次数 / 字节数、有分配的帧数、单帧最多次数，以及整个运行期间各阶段的分配
+    std::uint64_t allocs = 0;
+    std::uint64_t allocBytes = 0;
+    std::uint64_t allocFrames = 0;
+    std::uint64_t maxFrameAllocs = 0;
+    AllocCounts phaseAllocs[(int)AllocPhase::COUNT] = {};
+
+    void record(double ms, double budgetMs, std::size_t enemies, std::size_t projectiles, std::size_t particles,
+                const AllocCounts& allocated);
+    // 百分位帧耗时（ms，按直方图档位的上沿）
+    double percentile(double p) const;
+};
+
 class Game {
 public:
-    explicit Game(std::string mapFilePath = "");
+    explicit Game(const GameOptions& options = GameOptions{});
     void runLoop();
 
+    // runLoop 拆开的三步，供服务器在自己的节拍上逐帧驱动多个会话：
+    // begin() 一次，之后每个逻辑帧 frame()（读输入、更新、绘制），running() 变为 false 或会话结束时 end()
+    void begin();
+    void frame();
+    void end();
+    bool running() const { return running_; }
+    // 菜单 / 结束画面已经画好、也没有待处理的按键：不必运行 frame()
+    bool idle() const { return state_ != GameState::PLAYING && drawnState_ == state_ && !input_.pending(); }
+    void feedInput(const char* data, std::size_t size) { input_.feed(data, size); }
+
+    const FrameStats& stats() const { return stats_; }
+    int tickRate() const;
+
+    // 整个模拟状态（实体、地形、随机数、帧号、关卡）的 64 位哈希；需开启 GameOptions::trace
+    std::uint64_t stateHash();
+    // 每个游戏帧结束时的 stateHash()
+    const std::vector<std::uint64_t>& trace() const { return trace_; }
+
+    // --alloc-check 发现稳态帧中的分配（调用栈已输出到 stderr）
+    bool allocFailed() const { return allocFailure_; }
+
 private:
     void handleInput(const InputState &input);
     void handleMenuInput(const InputState &input);
@@ -29,30 +105,123 @@ private:
     void render();
     void renderMenu();
     
-    void spawnEnemies();
+    // 刷怪与关卡推进都是协程脚本：关卡脚本按原型表的 [level N] 数据运行，
+    // 生存模式的强度曲线写在它自己的脚本里
+    Encounter campaignScript(); // 依次进行各关，等过关条件满足后换关 / 通关
+    Encounter patrolScript(const LevelDef& level);
+    Encounter waveScript(const LevelDef& level);
+    Encounter survivalBomberScript();
+    Encounter survivalWaveScript();
+    void placeStartShips(const LevelDef& level);
+    void spawnAtEdge(EnemyType type);
+    void spawnAroundPlayer(EnemyType type); // 生存模式：刷在视口外的一圈里
+    void addEnemy(int row, int col, EnemyType type, int dir = 1);
     void spawnPickups();
-    void checkCollisions();
-    void collectProjectiles();
 
+    void newGame();
     void startLevel(int newLevel);
+    void reloadMap(); // 地图文件变化时热重载
+    void applyTerrainChanges(); // 按 World 的脏集合增量更新由地形派生的数据，然后清空脏集合
+    void cameraOrigin(int& row, int& col) const;
+    IslandParams levelIslands(int level) const;  // 第 level 关的岛屿参数；不带 --seed 时从 gameRng() 取种子
+    void startFitSize(int level, int& height, int& width) const; // 第 level 关开局舰船的包围盒（没有则为 0）
+    void prepareNextLevel(); // 换关后立即在后台生成下一关的地形
 
-    World world_;
-    Renderer renderer_;
+    int survivalSeconds() const;
+    void formatTicks(std::uint32_t ticks, char* out, std::size_t size) const; // m:ss
+    void recordSurvival(); // 本局结束：刷新并保存最高纪录
+    void hashTouched();    // 清理死亡实体之前，重算本帧改动过的实体摘要
+    void publishSnapshot(); // 把本帧的实体与 HUD 写进共享内存的快照环
+    void emitEffects();     // 清理死亡实体之前，按本帧的击毁、命中、开火与鱼雷航迹发射粒子
+
+    Rng rng_; // 构造与 frame() 期间绑定为本线程的 gameRng()
+    World world_; // 构造时是空地图，第一关的地形在 newGame → startLevel 里才生成（只生成一次）
+    std::unique_ptr<Renderer> renderer_;
     InputManager input_;
+    Autopilot autopilot_;
+    bool useAutopilot_ = false;
+    bool survival_ = false;
+    bool bench_ = false;
     bool running_ = false;
+    std::uint64_t maxFrames_ = 0;
+    FrameStats stats_;
+
+    // 输出自适应：慢链路上降低绘制频率与细节，逻辑帧照常推进
+    LinkAdapter link_;
+    std::uint64_t playFrames_ = 0; // 游戏中的逻辑帧数，决定哪些帧需要绘制
+    bool overlay_ = false;
+
+    // 分配检查：前 kAllocWarmupFrames 个游戏帧用来让各缓冲区长到工作规模
+    static constexpr int kAllocPhases = (int)AllocPhase::COUNT;
+    static constexpr std::uint64_t kAllocWarmupFrames = 300;
+    bool allocCheck_ = false;
+    bool allocFailure_ = false;
+    AllocCounts phaseStart_[kAllocPhases];
+    std::uint64_t mapReloads_ = 0;
+
+    // 状态哈希：只重算本帧动过的实体（行动/被击中的敌舰、新刷出的实体、所有投射物、玩家）
+    bool tracing_ = false;
+    StateHash stateHash_;
+    std::vector<std::uint64_t> trace_;
+    std::size_t settledEnemies_ = 0; // 上次清理后的表长，之后追加的行都是本帧新刷出的
+    std::size_t settledPickups_ = 0;
+    SnapshotWriter snapshots_; // --snapshots：供外部工具读取的状态快照
+    EventLog events_;          // --events：玩法事件日志，由后台线程写盘
     GameState state_ = GameState::MENU;
+    GameState drawnState_ = GameState::PLAYING; // 最近一帧画的是哪个状态的画面
     int menuSelection_ = 0;
     
-    std::unique_ptr<PlayerShip> player_;
-    std::vector<std::unique_ptr<EnemyShip>> enemies_;
-    std::vector<std::unique_ptr<Projectile>> projectiles_;
-    std::vector<std::unique_ptr<Pickup>> pickups_;
-    
-    int spawnTimer_ = 0;
+    // 所有实体都在注册表里；玩家是 PlayerTable 中唯一的一行
+    GameRegistry registry_;
+    EntityId player_;
+    CollisionSystem collisions_;
+    EnemyAiSystem enemyAi_;
+    LineOfSight sight_; // 本帧各格能否看到玩家，所有敌舰共享
+    bool fog_ = false;
+    FieldOfView fov_;   // 玩家视野（战争迷雾），只在玩家移动或地形变化时重算
+    ParticleSystem particles_; // 特效层，纯视觉，不计入状态哈希
+    Minimap minimap_;          // 大地图（生存模式）右上角的小地图
+
+    // 所有“每隔 N 帧”的逻辑（敌舰移动/开火、弹药回复）都登记在时间轮上
+    TimerWheel timers_;
+    std::vector<TimerEvent> dueEvents_;
+    std::uint32_t levelEpoch_ = 0;       // 开局 / 换关的次数
+    std::vector<std::uint8_t> occupied_; // 从边缘刷怪、开局放置舰船时的占用格（rows × cols）
+    LevelPreparer preparer_;             // 下一关的地形与放置表在后台线程上生成，换关时移交
+    std::vector<std::uint8_t> startFits_; // 本关开局舰船的放置表（见 PreparedLevel::startFits）
+    int startFitHeight_ = 0;
+    int startFitWidth_ = 0;
+
+    // 遭遇脚本；计数器供脚本等待：金币数（每帧末同步）与各舰种的存活数（刷出 / 清理时增减）
+    ScriptScheduler scripts_;
+    std::vector<ScriptId> levelScripts_; // 本关的刷怪脚本，换关时取消
+    ScriptScheduler::CounterId coinsCounter_ = 0;
+    std::vector<ScriptScheduler::CounterId> aliveCounters_; // 按 EnemyType
+    int pickupChance_ = 0;
+    static constexpr std::uint32_t kShellRegenInterval = 10;
+    static constexpr std::uint32_t kMissileRegenInterval = 1000;
+
+    EnemyType gunboatType_ = 0;
+    EnemyType destroyerType_ = 0;
+    EnemyType cruiserType_ = 0;
+    EnemyType bomberType_ = 0;
 
     std::string mapFilePath_;
+    std::uint32_t seed_ = 0;
+    int density_ = 0;
+    MapWatcher mapWatcher_;
 
     int level_ = 1;
-    static constexpr int kLevel1WinCoins = 100;
-    static constexpr int kLevel2WinCoins = 200;
+    static constexpr int kLevelTickRate = 30;
+
+    // 生存模式
+    static constexpr int kSurvivalTickRate = 60;
+    static constexpr int kSurvivalRows = 120;
+    static constexpr int kSurvivalCols = 360;
+    static constexpr int kSurvivalSpawnBand = 40; // 刷怪圈在视口外的宽度
+    static constexpr int kSurvivalPickupChance = 200;
+    static constexpr const char* kHighScorePath = "highscore.txt";
+    std::uint32_t survivalStart_ = 0;
+    bool recordSaved_ = false;
+    HighScore best_;
 };
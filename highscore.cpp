@@ -0,0 +1,40 @@
+#include "highscore.h"
+#include <fstream>
+#include <mutex>
+
+namespace {
+// 服务器进程里多个会话线程可能同时读写同一个纪录文件
+std::mutex fileMutex;
+} // namespace
+
+bool loadHighScore(const std::string& path, HighScore* out) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    HighScore loaded;
+    std::string key;
+    bool any = false;
+    while (in >> key) {
+        if (key == "score") {
+            if (!(in >> loaded.score)) return false;
+        } else if (key == "ticks") {
+            if (!(in >> loaded.ticks)) return false;
+        } else {
+            return false;
+        }
+        any = true;
+    }
+    if (!any) return false;
+    *out = loaded;
+    return true;
+}
+
+bool saveHighScore(const std::string& path, const HighScore& score) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) return false;
+    out << "score " << score.score << "\n";
+    out << "ticks " << score.ticks << "\n";
+    return (bool)out;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// 生存模式的最高纪录，保存为文本文件（每行 "键 值"）：
+//   score <最高得分>
+//   ticks <最长生存帧数>
+struct HighScore {
+    int score = 0;
+    std::uint32_t ticks = 0;
+};
+
+// 文件不存在或格式不对时返回 false，*out 保持默认值
+bool loadHighScore(const std::string& path, HighScore* out);
+bool saveHighScore(const std::string& path, const HighScore& score);
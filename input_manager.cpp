@@ -1,8 +1,47 @@
 #include "input_manager.h"
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+
+int InputManager::readKey() {
+    // 不阻塞地把已到达的字节收进 pending_
+    if (fd_ >= 0 && pendingLen_ < (int)sizeof(pending_)) {
+        pollfd pfd{fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+            const ssize_t n = ::read(fd_, pending_ + pendingLen_, sizeof(pending_) - pendingLen_);
+            if (n > 0) pendingLen_ += (int)n;
+        }
+    }
+    if (pendingLen_ == 0) return ERR;
+
+    int key = (unsigned char)pending_[0];
+    int used = 1;
+    // 方向键：ESC [ A/B/C/D
+    if (key == 27 && pendingLen_ >= 3 && pending_[1] == '[') {
+        switch (pending_[2]) {
+            case 'A': key = KEY_UP; break;
+            case 'B': key = KEY_DOWN; break;
+            case 'C': key = KEY_RIGHT; break;
+            case 'D': key = KEY_LEFT; break;
+            default: key = ERR; break;
+        }
+        used = 3;
+    }
+    pendingLen_ -= used;
+    std::memmove(pending_, pending_ + used, pendingLen_);
+    return key;
+}
+
+void InputManager::feed(const char* data, std::size_t size) {
+    const std::size_t room = sizeof(pending_) - (std::size_t)pendingLen_;
+    if (size > room) size = room;
+    std::memcpy(pending_ + pendingLen_, data, size);
+    pendingLen_ += (int)size;
+}
 
 InputState InputManager::poll() {
     InputState state;
-    int ch = getch();
+    int ch = useCurses_ ? getch() : readKey();
     switch (ch) {
     case KEY_UP:
         state.dRow = -1;
@@ -33,6 +72,10 @@ InputState InputManager::poll() {
     case 'U':
         state.fireMissile = true;
         break;
+    case 'i':
+    case 'I':
+        state.toggleOverlay = true;
+        break;
     case 'q':
     case 'Q':
         state.quit = true;
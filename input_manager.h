@@ -1,5 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <ncurses.h>
+#include <unistd.h>
 
 struct InputState {
     int dRow = 0;
@@ -10,10 +12,29 @@ struct InputState {
     bool fireSpreadLeft = false;
     bool fireSpreadRight = false;
     bool fireMissile = false;
+    bool toggleOverlay = false; // I：开关调试浮层
     bool quit = false;
 };
 
 class InputManager {
 public:
+    // useCurses：用 ncurses 的 getch() 读键；否则直接从 fd（默认标准输入）读取并解析方向键的转义序列
+    // （配合 ANSI / 内存渲染后端，此时 ncurses 没有初始化）。fd 为 -1 时不读任何描述符，
+    // 按键由 feed() 送进来（服务器会话：工作线程从套接字读到数据后转交）
+    explicit InputManager(bool useCurses = true, int fd = STDIN_FILENO) : useCurses_(useCurses), fd_(fd) {}
+
     InputState poll();
+
+    // 追加收到的按键字节；缓冲区满时多出的部分丢弃
+    void feed(const char* data, std::size_t size);
+    // 还有没处理的按键
+    bool pending() const { return pendingLen_ > 0; }
+
+private:
+    int readKey();
+
+    bool useCurses_;
+    int fd_;
+    char pending_[32];
+    int pendingLen_ = 0;
 };
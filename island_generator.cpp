@@ -0,0 +1,363 @@
+#include "island_generator.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+constexpr int kParallelCells = 1 << 18; // 小于这个面积的地图单线程生成，省掉建线程的开销
+constexpr int kChannelHalfWidth = 1;    // 水道宽 3 格
+
+// 把 [0, rows) 切成 bands 段，每段一个线程（第 0 段在当前线程）
+template <class Fn>
+void forEachBand(int rows, int bands, Fn&& fn) {
+    if (bands <= 1) {
+        fn(0, 0, rows);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(bands - 1);
+    for (int b = 1; b < bands; ++b) {
+        workers.emplace_back([&fn, rows, bands, b]() {
+            fn(b, (int)((long long)rows * b / bands), (int)((long long)rows * (b + 1) / bands));
+        });
+    }
+    fn(0, 0, (int)((long long)rows / bands));
+    for (std::thread& t : workers) t.join();
+}
+
+// murmur3 的 32 位收尾混合
+std::uint32_t mix32(std::uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// 水面的一段横向连续区间 [start, end]
+struct Run {
+    int row;
+    int start;
+    int end;
+};
+
+class Generator {
+public:
+    Generator(const IslandParams& params, int rows, int cols, std::vector<std::uint64_t>& bits)
+        : p_(params), rows_(rows), cols_(cols), words_((cols + 63) / 64), bits_(bits) {
+        lastMask_ = (cols % 64 == 0) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (cols % 64)) - 1);
+        const int hw = p_.threads > 0 ? p_.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+        bands_ = (long long)rows * cols < kParallelCells ? 1 : std::min(hw, rows);
+    }
+
+    void run(IslandStats* stats) {
+        bits_.assign((std::size_t)rows_ * words_, 0);
+        scratch_.assign(bits_.size(), 0);
+        zeroRow_.assign(words_, 0);
+
+        forEachBand(rows_, bands_, [this](int, int r0, int r1) { noise(r0, r1); });
+        for (int pass = 0; pass < p_.smoothingPasses; ++pass) {
+            forEachBand(rows_, bands_, [this](int, int r0, int r1) { smooth(r0, r1); });
+            bits_.swap(scratch_);
+            forEachBand(rows_, bands_, [this](int, int r0, int r1) { clearMargins(r0, r1); });
+        }
+
+        IslandStats local;
+        connect(local);
+        if (stats) *stats = local;
+    }
+
+private:
+    bool isLand(int row, int col) const {
+        return (bits_[(std::size_t)row * words_ + col / 64] >> (col % 64)) & 1;
+    }
+
+    void setWater(int row, int col) {
+        bits_[(std::size_t)row * words_ + col / 64] &= ~(std::uint64_t{1} << (col % 64));
+    }
+
+    // 每格一个只由 (seed, row, col) 决定的哈希值，低于阈值为陆地；一个字在寄存器里拼好再写回
+    void noise(int r0, int r1) {
+        const int density = std::max(0, std::min(100, p_.density));
+        const std::uint64_t threshold = ((std::uint64_t)density << 32) / 100;
+        for (int r = r0; r < r1; ++r) {
+            const std::uint32_t rowKey = mix32(p_.seed * 0x9E3779B9u ^ (std::uint32_t)r * 0x85EBCA6Bu);
+            std::uint64_t* row = &bits_[(std::size_t)r * words_];
+            for (int w = 0; w < words_; ++w) {
+                const int n = std::min(64, cols_ - w * 64);
+                std::uint64_t word = 0;
+                for (int b = 0; b < n; ++b) {
+                    const std::uint32_t h = mix32(rowKey + (std::uint32_t)(w * 64 + b) * 0xC2B2AE35u);
+                    word |= (std::uint64_t)(h < threshold) << b;
+                }
+                row[w] = word;
+            }
+        }
+        clearMargins(r0, r1);
+    }
+
+    void clearMargins(int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            std::uint64_t* row = &bits_[(std::size_t)r * words_];
+            if (r < p_.marginRows || r >= rows_ - p_.marginRows) {
+                std::fill(row, row + words_, 0);
+                continue;
+            }
+            for (int c = 0; c < p_.marginCols && c < cols_; ++c) {
+                row[c / 64] &= ~(std::uint64_t{1} << (c % 64));
+                const int cr = cols_ - 1 - c;
+                row[cr / 64] &= ~(std::uint64_t{1} << (cr % 64));
+            }
+        }
+    }
+
+    // 元胞自动机一步（4-5 规则）：8 邻域中陆地 ≥5 变陆地，本身是陆地且 ≥4 保持陆地。
+    // 8 个邻居按位对齐后逐位累加成 4 个位平面，一次处理 64 格；地图外视为海面。
+    void smooth(int r0, int r1) {
+        for (int r = r0; r < r1; ++r) {
+            const std::uint64_t* up = r > 0 ? &bits_[(std::size_t)(r - 1) * words_] : zeroRow_.data();
+            const std::uint64_t* mid = &bits_[(std::size_t)r * words_];
+            const std::uint64_t* down = r + 1 < rows_ ? &bits_[(std::size_t)(r + 1) * words_] : zeroRow_.data();
+            std::uint64_t* out = &scratch_[(std::size_t)r * words_];
+
+            for (int w = 0; w < words_; ++w) {
+                auto west = [&](const std::uint64_t* row) {
+                    return (row[w] << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+                };
+                auto east = [&](const std::uint64_t* row) {
+                    return (row[w] >> 1) | (w + 1 < words_ ? row[w + 1] << 63 : 0);
+                };
+
+                std::uint64_t b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+                auto add = [&](std::uint64_t x) {
+                    const std::uint64_t c0 = b0 & x;
+                    b0 ^= x;
+                    const std::uint64_t c1 = b1 & c0;
+                    b1 ^= c0;
+                    const std::uint64_t c2 = b2 & c1;
+                    b2 ^= c1;
+                    b3 |= c2;
+                };
+                add(up[w]);
+                add(west(up));
+                add(east(up));
+                add(west(mid));
+                add(east(mid));
+                add(down[w]);
+                add(west(down));
+                add(east(down));
+
+                const std::uint64_t atLeast4 = b2 | b3;
+                const std::uint64_t atLeast5 = b3 | (b2 & (b1 | b0));
+                std::uint64_t next = atLeast5 | (mid[w] & atLeast4);
+                if (w == words_ - 1) next &= lastMask_;
+                out[w] = next;
+            }
+        }
+    }
+
+    // 从 col 起（含）下一个水面 / 陆地格，没有则返回 cols_
+    int nextCell(const std::uint64_t* row, int col, bool land) const {
+        if (col >= cols_) return cols_;
+        int w = col / 64;
+        std::uint64_t x = (land ? row[w] : ~row[w]) & (~std::uint64_t{0} << (col % 64));
+        while (x == 0) {
+            if (++w >= words_) return cols_;
+            x = land ? row[w] : ~row[w];
+        }
+        return std::min(cols_, w * 64 + __builtin_ctzll(x));
+    }
+
+    int find(int x) {
+        while (parent_[x] != x) {
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
+        }
+        return x;
+    }
+
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        parent_[a] = b;
+    }
+
+    // 合并第 row-1 行与第 row 行上下重叠（4 连通）的水面区间
+    void uniteRows(int row) {
+        int i = rowFirst_[row - 1];
+        int j = rowFirst_[row];
+        const int iEnd = rowFirst_[row];
+        const int jEnd = rowFirst_[row + 1];
+        while (i < iEnd && j < jEnd) {
+            const Run& a = runs_[i];
+            const Run& b = runs_[j];
+            if (a.start <= b.end && b.start <= a.end) unite(i, j);
+            if (a.end < b.end) ++i; else ++j;
+        }
+    }
+
+    // 包含 (row, col) 的水面区间下标；不在任何区间里（陆地或新开的水道）时返回 -1
+    int runAt(int row, int col) const {
+        const Run* first = runs_.data() + rowFirst_[row];
+        const Run* last = runs_.data() + rowFirst_[row + 1];
+        const Run* it = std::upper_bound(first, last, col, [](int c, const Run& run) { return c < run.start; });
+        if (it == first) return -1;
+        --it;
+        return col <= it->end ? (int)(it - runs_.data()) : -1;
+    }
+
+    void carve(int row, int col, bool vertical) {
+        for (int d = -kChannelHalfWidth; d <= kChannelHalfWidth; ++d) {
+            const int r = vertical ? row : row + d;
+            const int c = vertical ? col + d : col;
+            if (r >= 0 && r < rows_ && c >= 0 && c < cols_) setWater(r, c);
+        }
+    }
+
+    void connect(IslandStats& stats) {
+        // 1. 各段并行提取水面区间
+        std::vector<std::vector<Run>> bandRuns(bands_);
+        forEachBand(rows_, bands_, [&](int b, int r0, int r1) {
+            std::vector<Run>& out = bandRuns[b];
+            for (int r = r0; r < r1; ++r) {
+                const std::uint64_t* row = &bits_[(std::size_t)r * words_];
+                int c = nextCell(row, 0, false);
+                while (c < cols_) {
+                    const int e = nextCell(row, c, true);
+                    out.push_back(Run{r, c, e - 1});
+                    c = nextCell(row, e, false);
+                }
+            }
+        });
+        std::size_t total = 0;
+        for (const std::vector<Run>& band : bandRuns) total += band.size();
+        runs_.reserve(total);
+        for (const std::vector<Run>& band : bandRuns) runs_.insert(runs_.end(), band.begin(), band.end());
+        bandRuns.clear();
+
+        rowFirst_.assign(rows_ + 1, 0);
+        for (const Run& run : runs_) rowFirst_[run.row + 1]++;
+        for (int r = 0; r < rows_; ++r) rowFirst_[r + 1] += rowFirst_[r];
+
+        // 2. 并查集：段内各自合并（下标区间互不重叠，可并行），再串行合并段与段的交界
+        parent_.resize(runs_.size());
+        for (std::size_t i = 0; i < parent_.size(); ++i) parent_[i] = (int)i;
+        forEachBand(rows_, bands_, [&](int, int r0, int r1) {
+            for (int r = r0 + 1; r < r1; ++r) uniteRows(r);
+        });
+        for (int b = 1; b < bands_; ++b) {
+            const int r = (int)((long long)rows_ * b / bands_);
+            if (r > 0) uniteRows(r);
+        }
+        if (runs_.empty()) return;
+
+        // 3. 统计各水域面积，最大的是主海域
+        std::vector<long long> area(runs_.size(), 0);
+        std::vector<int> firstRun(runs_.size(), -1);
+        for (int i = 0; i < (int)runs_.size(); ++i) {
+            const int root = find(i);
+            area[root] += runs_[i].end - runs_[i].start + 1;
+            if (firstRun[root] < 0) firstRun[root] = i;
+        }
+        int main = 0;
+        std::vector<int> regions;
+        for (int i = 0; i < (int)runs_.size(); ++i) {
+            if (parent_[i] != i) continue;
+            regions.push_back(i);
+            if (area[i] > area[main]) main = i;
+        }
+        stats.waterRegions = (int)regions.size();
+
+        // 4. 小水塘填成陆地
+        std::vector<char> filled(runs_.size(), 0);
+        for (int root : regions) {
+            if (root == main || area[root] >= p_.minLakeCells) continue;
+            filled[root] = 1;
+            stats.filledLakes++;
+        }
+        if (stats.filledLakes > 0) {
+            for (int i = 0; i < (int)runs_.size(); ++i) {
+                if (!filled[find(i)]) continue;
+                const Run& run = runs_[i];
+                for (int c = run.start; c <= run.end; ++c) {
+                    bits_[(std::size_t)run.row * words_ + c / 64] |= std::uint64_t{1} << (c % 64);
+                }
+            }
+        }
+
+        // 5. 其余水域：从代表格沿四个方向找最近的其它水域，开凿直水道并合并，直到全部连进主海域
+        static const int kDirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        bool pending = true;
+        while (pending) {
+            pending = false;
+            for (int root : regions) {
+                if (filled[root] || find(root) == find(main)) continue;
+                pending = true;
+
+                const Run& rep = runs_[firstRun[root]];
+                const int self = find(root);
+                int bestDist = -1;
+                int bestDir = 0;
+                int bestRun = -1;
+                for (int d = 0; d < 4; ++d) {
+                    int r = rep.row;
+                    int c = rep.start;
+                    for (int dist = 1;; ++dist) {
+                        r += kDirs[d][0];
+                        c += kDirs[d][1];
+                        if (r < 0 || r >= rows_ || c < 0 || c >= cols_) break;
+                        if (bestDist >= 0 && dist >= bestDist) break;
+                        if (isLand(r, c)) continue;
+                        const int other = runAt(r, c);
+                        if (other < 0 || filled[find(other)] || find(other) == self) continue;
+                        bestDist = dist;
+                        bestDir = d;
+                        bestRun = other;
+                        break;
+                    }
+                }
+
+                if (bestRun < 0) {
+                    // 四个方向都没有（没有边缘海面时可能发生）：先竖后横挖到主海域的代表格
+                    const Run& target = runs_[firstRun[main]];
+                    const int stepR = target.row > rep.row ? 1 : -1;
+                    for (int r = rep.row; r != target.row; r += stepR) carve(r, rep.start, true);
+                    const int stepC = target.start > rep.start ? 1 : -1;
+                    for (int c = rep.start; c != target.start; c += stepC) carve(target.row, c, false);
+                    carve(target.row, target.start, false);
+                    unite(self, main);
+                } else {
+                    const bool vertical = kDirs[bestDir][0] != 0;
+                    for (int dist = 1; dist < bestDist; ++dist) {
+                        carve(rep.row + kDirs[bestDir][0] * dist, rep.start + kDirs[bestDir][1] * dist, vertical);
+                    }
+                    unite(self, bestRun);
+                }
+                stats.channels++;
+            }
+        }
+    }
+
+    const IslandParams& p_;
+    int rows_;
+    int cols_;
+    int words_;
+    int bands_ = 1;
+    std::uint64_t lastMask_;
+    std::vector<std::uint64_t>& bits_;
+    std::vector<std::uint64_t> scratch_;
+    std::vector<std::uint64_t> zeroRow_;
+    std::vector<Run> runs_;
+    std::vector<int> rowFirst_; // 第 r 行的区间占 runs_[rowFirst_[r], rowFirst_[r + 1])
+    std::vector<int> parent_;
+};
+
+} // namespace
+
+void generateIslands(const IslandParams& params, int rows, int cols,
+                     std::vector<std::uint64_t>& bits, IslandStats* stats) {
+    Generator(params, rows, cols, bits).run(stats);
+}
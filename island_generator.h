@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 程序化岛屿生成：逐格哈希噪声 → 元胞自动机平滑出海岸线 → 并查集连通性检查，
+// 把封闭的小水塘填平、为其余不连通的水域开凿水道，保证所有海面彼此可达。
+// 地形按行打包成位图（64 格一个字），平滑与连通性都按字处理；大地图按行分段多线程生成。
+// 结果只取决于参数，与线程数无关。
+struct IslandParams {
+    std::uint32_t seed = 1;
+    int density = 42;        // 初始陆地比例（%）；平滑后陆地会收缩成成片的岛屿
+    int smoothingPasses = 4; // 元胞自动机迭代次数
+    int marginRows = 5;      // 上下边缘保持为海面的行数（刷怪点与出生点）
+    int marginCols = 2;      // 左右边缘保持为海面的列数
+    int minLakeCells = 8;    // 小于此面积的封闭水域直接填成陆地
+    int threads = 0;         // 0 表示使用全部核心
+};
+
+struct IslandStats {
+    int waterRegions = 0; // 连通性检查前的水域数
+    int filledLakes = 0;
+    int channels = 0;     // 开凿的水道数
+};
+
+// 生成 rows×cols 的地形位图：与 World::rowWord 同布局，1 为陆地，每行 (cols + 63) / 64 个字，
+// 行尾多余的位为 0
+void generateIslands(const IslandParams& params, int rows, int cols,
+                     std::vector<std::uint64_t>& bits, IslandStats* stats = nullptr);
@@ -0,0 +1,94 @@
+#include "level_preparer.h"
+#include "alloc_tracker.h"
+#include <algorithm>
+#include <chrono>
+
+void buildStartFits(const World& world, int height, int width, std::vector<std::uint8_t>& fits) {
+    const int rows = world.rows();
+    const int cols = world.cols();
+    // 先按行算出每格向右连续的空格数，包围盒放得下 ⇔ 它覆盖的每一行在左上角这一列的连续空格都够宽
+    std::vector<int> runRight((std::size_t)rows * cols, 0);
+    for (int r = 0; r < rows; ++r) {
+        int run = 0;
+        for (int c = cols - 1; c >= 0; --c) {
+            run = world.isBlocked(r, c) ? 0 : run + 1;
+            runRight[(std::size_t)r * cols + c] = run;
+        }
+    }
+    fits.assign((std::size_t)rows * cols, 0);
+    for (int r = 0; r + height <= rows; ++r) {
+        for (int c = 0; c + width <= cols; ++c) {
+            bool fit = true;
+            for (int dr = 0; dr < height && fit; ++dr) fit = runRight[(std::size_t)(r + dr) * cols + c] >= width;
+            fits[(std::size_t)r * cols + c] = fit ? 1 : 0;
+        }
+    }
+}
+
+void updateStartFits(const World& world, int height, int width, std::vector<std::uint8_t>& fits,
+                     const std::vector<CellChange>& changes) {
+    const int rows = world.rows();
+    const int cols = world.cols();
+    for (const CellChange& change : changes) {
+        const int top = std::max(0, change.row - height + 1);
+        const int left = std::max(0, change.col - width + 1);
+        for (int r = top; r <= change.row && r + height <= rows; ++r) {
+            for (int c = left; c <= change.col && c + width <= cols; ++c) {
+                bool fit = true;
+                for (int dr = 0; dr < height && fit; ++dr) {
+                    for (int dc = 0; dc < width && fit; ++dc) fit = !world.isBlocked(r + dr, c + dc);
+                }
+                fits[(std::size_t)r * cols + c] = fit ? 1 : 0;
+            }
+        }
+    }
+}
+
+PreparedLevel prepareLevel(int level, int rows, int cols, const IslandParams& islands, int fitHeight, int fitWidth) {
+    PreparedLevel prepared;
+    prepared.level = level;
+    prepared.world = World(rows, cols, islands);
+    prepared.fitHeight = fitHeight;
+    prepared.fitWidth = fitWidth;
+    if (fitHeight > 0 && fitWidth > 0) buildStartFits(prepared.world, fitHeight, fitWidth, prepared.startFits);
+    return prepared;
+}
+
+LevelPreparer::~LevelPreparer() {
+    discard();
+    for (std::future<PreparedLevel>& job : stale_) job.wait();
+}
+
+void LevelPreparer::prepare(int level, int rows, int cols, const IslandParams& islands, int fitHeight, int fitWidth) {
+    discard();
+    IslandParams background = islands;
+    background.threads = 1; // 结果与线程数无关；后台只占一个核，不和游戏线程抢
+    level_ = level;
+    pending_ = std::async(std::launch::async, [=] {
+        setAllocPhase(AllocPhase::BACKGROUND);
+        return prepareLevel(level, rows, cols, background, fitHeight, fitWidth);
+    });
+}
+
+bool LevelPreparer::take(int level, PreparedLevel& out) {
+    if (!pending_.valid()) return false;
+    if (level_ != level) {
+        discard();
+        return false;
+    }
+    out = pending_.get();
+    return true;
+}
+
+void LevelPreparer::discard() {
+    // async 的 future 析构时会等任务结束，所以不能直接丢掉，先挪到 stale_ 里
+    if (pending_.valid()) stale_.push_back(std::move(pending_));
+    level_ = 0;
+    reap();
+}
+
+void LevelPreparer::reap() {
+    std::erase_if(stale_, [](std::future<PreparedLevel>& job) {
+        return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <vector>
+#include "world.h"
+
+// 准备好的一关：地形与只取决于地形的派生数据
+struct PreparedLevel {
+    int level = 0;
+    World world;
+    // 开局舰船的放置表（rows × cols）：包围盒以该格为左上角时不出界、不碰障碍即为 1。
+    // 放置本身要用换关那一刻的游戏随机数，仍在主线程上做，每次尝试只需查表
+    int fitHeight = 0;
+    int fitWidth = 0;
+    std::vector<std::uint8_t> startFits;
+};
+
+// 按 world 的地形建 height × width 包围盒的放置表
+void buildStartFits(const World& world, int height, int width, std::vector<std::uint8_t>& fits);
+// 地形部分变化后只重算包围盒盖住变化格子的那些左上角
+void updateStartFits(const World& world, int height, int width, std::vector<std::uint8_t>& fits,
+                     const std::vector<CellChange>& changes);
+
+// 生成第 level 关：rows × cols 的随机岛屿，并为 fitHeight × fitWidth 的包围盒建放置表（为 0 时不建）
+PreparedLevel prepareLevel(int level, int rows, int cols, const IslandParams& islands, int fitHeight, int fitWidth);
+
+// 在后台线程上提前准备下一关。换关时 take() 直接把做好的结果移交过来（vector 交换指针，
+// 远小于一帧）；后台还没做完就等它做完。作废的任务不等它结束，留在后台做完后顺手回收，
+// 析构时才等所有任务结束。后台线程的分配记在 AllocPhase::BACKGROUND 名下，不计入游戏帧。
+class LevelPreparer {
+public:
+    LevelPreparer() = default;
+    ~LevelPreparer();
+    LevelPreparer(const LevelPreparer&) = delete;
+    LevelPreparer& operator=(const LevelPreparer&) = delete;
+
+    // 开始在后台准备第 level 关（参数同 prepareLevel）；之前的任务没被取走就作废（不等它）
+    void prepare(int level, int rows, int cols, const IslandParams& islands, int fitHeight, int fitWidth);
+    // 取走为第 level 关准备的结果；没有为它准备过（或准备的是别的关，顺带作废）时返回 false
+    bool take(int level, PreparedLevel& out);
+    // 作废正在准备或已准备好的结果（例如地图来源变了），立即返回
+    void discard();
+
+private:
+    void reap(); // 回收已经做完的作废任务
+
+    std::future<PreparedLevel> pending_;
+    int level_ = 0;
+    std::vector<std::future<PreparedLevel>> stale_; // 作废了但可能还在做的任务
+};
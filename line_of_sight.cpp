@@ -0,0 +1,140 @@
+#include "line_of_sight.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 一条射线在某一行上经过的列区间（相对起点）
+struct RaySpan {
+    std::int8_t dRow;
+    std::int8_t colLo;
+    std::int8_t colHi;
+};
+
+constexpr int kRayRows = 2 * LineOfSight::kRangeRows + 1;
+constexpr int kRayCols = 2 * LineOfSight::kRangeCols + 1;
+
+// 所有相对位移 (dRow, dCol) 的射线，按位移下标连续存放：
+// 第 i 条射线占 spans[begin[i], begin[i + 1])
+struct RayTable {
+    std::vector<std::uint32_t> begin;
+    std::vector<RaySpan> spans;
+
+    RayTable() {
+        begin.reserve(kRayRows * kRayCols + 1);
+        for (int dr = -LineOfSight::kRangeRows; dr <= LineOfSight::kRangeRows; ++dr) {
+            for (int dc = -LineOfSight::kRangeCols; dc <= LineOfSight::kRangeCols; ++dc) {
+                begin.push_back((std::uint32_t)spans.size());
+                build(dr, dc);
+            }
+        }
+        begin.push_back((std::uint32_t)spans.size());
+    }
+
+    void build(int dr, int dc) {
+        const std::size_t first = spans.size();
+        const int adr = std::abs(dr);
+        const int adc = std::abs(dc);
+        const int sr = dr > 0 ? 1 : (dr < 0 ? -1 : 0);
+        const int sc = dc > 0 ? 1 : (dc < 0 ? -1 : 0);
+        int err = adc - adr;
+        int r = 0;
+        int c = 0;
+        while (true) {
+            const int e2 = 2 * err;
+            if (e2 > -adr) { err -= adr; c += sc; }
+            if (e2 < adc) { err += adc; r += sr; }
+            if (r == dr && c == dc) break;
+
+            // 同一行内相邻的格子并入上一个区间
+            if (spans.size() > first && spans.back().dRow == r) {
+                RaySpan& s = spans.back();
+                if (c < s.colLo) s.colLo = (std::int8_t)c;
+                if (c > s.colHi) s.colHi = (std::int8_t)c;
+            } else {
+                spans.push_back(RaySpan{(std::int8_t)r, (std::int8_t)c, (std::int8_t)c});
+            }
+        }
+    }
+
+    const RaySpan* first(int dr, int dc) const {
+        return spans.data() + begin[index(dr, dc)];
+    }
+    const RaySpan* last(int dr, int dc) const {
+        return spans.data() + begin[index(dr, dc) + 1];
+    }
+
+    static int index(int dr, int dc) {
+        return (dr + LineOfSight::kRangeRows) * kRayCols + (dc + LineOfSight::kRangeCols);
+    }
+};
+
+const RayTable& rayTable() {
+    static const RayTable table;
+    return table;
+}
+
+// [lo, hi] 列中是否有障碍：每个 64 位字只做一次与运算
+bool spanBlocked(const World& world, int row, int lo, int hi) {
+    for (int w = lo / 64; w <= hi / 64; ++w) {
+        const int a = (lo > w * 64 ? lo : w * 64) - w * 64;
+        const int b = (hi < w * 64 + 63 ? hi : w * 64 + 63) - w * 64;
+        const int width = b - a + 1;
+        const std::uint64_t mask = (width == 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << width) - 1)) << a;
+        if (world.rowWord(row, w) & mask) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+LineOfSight::LineOfSight() {
+    rayTable(); // 射线表在构造时建好，避免第一次查询的那一帧卡顿
+}
+
+bool LineOfSight::clear(const World& world, int fromRow, int fromCol, int toRow, int toCol) {
+    if (!world.inBounds(fromRow, fromCol) || !world.inBounds(toRow, toCol)) return false;
+
+    const int dr = toRow - fromRow;
+    const int dc = toCol - fromCol;
+    if (std::abs(dr) > kRangeRows || std::abs(dc) > kRangeCols) return false;
+    // 两端之间的矩形在障碍金字塔上查不到障碍：开阔海面上不必逐段检查
+    if (!world.mayBeBlocked(std::min(fromRow, toRow), std::min(fromCol, toCol), std::abs(dr) + 1, std::abs(dc) + 1)) {
+        return true;
+    }
+
+    const RayTable& table = rayTable();
+    for (const RaySpan* s = table.first(dr, dc); s != table.last(dr, dc); ++s) {
+        if (spanBlocked(world, fromRow + s->dRow, fromCol + s->colLo, fromCol + s->colHi)) return false;
+    }
+    return true;
+}
+
+void LineOfSight::beginTick(const World& world, int targetRow, int targetCol) {
+    world_ = &world;
+    targetRow_ = targetRow;
+    targetCol_ = targetCol;
+    const std::size_t cells = (std::size_t)world.rows() * world.cols();
+    if (stamp_.size() != cells) {
+        // 地图尺寸变了（换关或换地图），缓存整体重建
+        stamp_.assign(cells, 0);
+        visible_.assign(cells, 0);
+        epoch_ = 0;
+    }
+    if (++epoch_ == 0) {
+        // 回绕时清空，避免旧标记被误认为本帧
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        epoch_ = 1;
+    }
+}
+
+bool LineOfSight::seesTarget(int row, int col) {
+    if (!world_ || !world_->inBounds(row, col)) return false;
+
+    const int idx = row * world_->cols() + col;
+    if (stamp_[idx] != epoch_) {
+        stamp_[idx] = epoch_;
+        visible_[idx] = clear(*world_, row, col, targetRow_, targetCol_) ? 1 : 0;
+    }
+    return visible_[idx] != 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "world.h"
+
+// 视线查询：两格之间的 Bresenham 直线（不含两端）上没有障碍即视为可见。
+// 每个相对位移的直线预先拆成“同一行内连续的列区间”，查询时把区间换成掩码，
+// 与 World 的按行障碍位图逐字相与，一次判断最多 64 格。
+class LineOfSight {
+public:
+    // 视距：行列位移超过一屏的目标一律视为不可见，射线表大小因此与地图尺寸无关
+    static constexpr int kRangeRows = World::kDefaultRows - 1;
+    static constexpr int kRangeCols = World::kDefaultCols - 1;
+
+    LineOfSight();
+
+    // 不经缓存的单次查询；任一端在界外或超出视距时返回 false
+    static bool clear(const World& world, int fromRow, int fromCol, int toRow, int toCol);
+
+    // 每帧开始时设定目标（通常是玩家）；之后同一帧内对同一格的查询直接命中缓存
+    void beginTick(const World& world, int targetRow, int targetCol);
+
+    // (row, col) 能否看到本帧的目标
+    bool seesTarget(int row, int col);
+
+private:
+    const World* world_ = nullptr;
+    int targetRow_ = 0;
+    int targetCol_ = 0;
+    std::uint32_t epoch_ = 0;
+    std::vector<std::uint32_t> stamp_;  // 本帧已查询过的格子（值为 epoch_）
+    std::vector<std::uint8_t> visible_; // 该格的查询结果
+};
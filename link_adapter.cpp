@@ -0,0 +1,86 @@
+#include "link_adapter.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr LinkAdapter::Mode kModes[] = {
+    {true, 1, "full"},
+    {false, 1, "mono"},
+    {false, 2, "mono 1/2"},
+    {false, 4, "mono 1/4"},
+    {false, 8, "mono 1/8"},
+};
+constexpr int kModeCount = (int)(sizeof(kModes) / sizeof(kModes[0]));
+
+// 耗时超过此值才算写入阻塞在终端上（而不只是系统调用本身的开销）
+constexpr double kBlockedMs = 1.0;
+
+// 吞吐按饱和期间的累计字节 / 累计时间估计，每次采样时旧数据按此比例衰减
+constexpr double kRateDecay = 0.97;
+
+} // namespace
+
+const LinkAdapter::Mode& LinkAdapter::mode() const {
+    return kModes[level_];
+}
+
+void LinkAdapter::record(const PresentCost& cost, double tickMs) {
+    const double budgetMs = tickMs * mode().renderEvery; // 也近似为距上一次 present() 的时间
+    sinceChangeMs_ += budgetMs;
+    if (sinceChangeMs_ >= kSettledMs) recoverMs_ = kRecoverMs;
+
+    flushMs_ += kSmoothing * (cost.ms - flushMs_);
+    bytes_ += kSmoothing * ((double)cost.bytes - bytes_);
+    // 吞吐只在链路饱和时可测：带着积压的这个绘制间隔里送出了多少（包括清空积压的那一次），
+    // 或阻塞写的速率
+    const bool backlogged = cost.backlog > 0 || backlog_ > 0;
+    backlog_ = cost.backlog;
+    cells_ = cost.cells;
+    if (backlogged || cost.ms > kBlockedMs) {
+        rateBytes_ = kRateDecay * rateBytes_ + (double)cost.bytes;
+        rateMs_ = kRateDecay * rateMs_ + (backlogged ? std::max(cost.ms, budgetMs) : cost.ms);
+        throughput_ = rateBytes_ * 1000.0 / rateMs_;
+    }
+
+    if (cost.backlog > 0 || flushMs_ > kDegradeShare * budgetMs) {
+        spareMs_ = 0;
+        if (++saturated_ >= kDegradeFrames && level_ + 1 < kModeCount) {
+            // 刚升上来就撑不住：带宽没恢复，下次多等一会再试
+            if (raised_ && sinceChangeMs_ < 2 * recoverMs_) recoverMs_ = std::min(2 * recoverMs_, kMaxRecoverMs);
+            change(level_ + 1);
+        }
+        return;
+    }
+    saturated_ = 0;
+    if (level_ == 0) return;
+
+    // 上一档绘制更频繁（或带颜色），按它的绘制间隔判断余量
+    const double upperBudgetMs = tickMs * kModes[level_ - 1].renderEvery;
+    if (flushMs_ < kRecoverShare * upperBudgetMs) {
+        spareMs_ += budgetMs;
+        if (spareMs_ >= recoverMs_) change(level_ - 1);
+    } else {
+        spareMs_ = 0;
+    }
+}
+
+void LinkAdapter::change(int level) {
+    raised_ = level < level_;
+    level_ = level;
+    saturated_ = 0;
+    spareMs_ = 0;
+    sinceChangeMs_ = 0;
+    if (level_ == 0) throughput_ = rateBytes_ = rateMs_ = 0;
+}
+
+void LinkAdapter::describe(char* out, std::size_t size) const {
+    char rate[32];
+    if (rateMs_ > 0) {
+        std::snprintf(rate, sizeof(rate), cells_ ? "%.1f Kcells/s" : "%.1f KB/s", throughput_ / 1024.0);
+    } else {
+        std::snprintf(rate, sizeof(rate), "unbounded");
+    }
+    std::snprintf(out, size, " %s | %s | %.2f ms %.0f %s/frame backlog %zu ", mode().name, rate, flushMs_, bytes_,
+                  cells_ ? "cells" : "B", backlog_);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include "renderer.h"
+
+// 输出自适应：慢终端 / SSH 链路上 present() 送不完一帧，画面越积越旧、主循环也会被拖住。
+// 每次 present() 后记录送出的字节数、耗时与积压，链路饱和时估计吞吐；持续饱和就逐级降低
+// 画面细节（先去掉颜色，再按 1/2、1/4、1/8 降低绘制频率——跳过的帧由差量刷新合并成一次
+// 输出），逻辑帧率不变。输出持续有余量时试探着升回一级；升级后很快又饱和说明带宽没恢复，
+// 下次等待的时间加倍。
+class LinkAdapter {
+public:
+    struct Mode {
+        bool color;
+        int renderEvery; // 每隔几个逻辑帧绘制一次
+        const char* name;
+    };
+
+    // 第 frame 个逻辑帧是否需要绘制
+    bool due(std::uint64_t frame) const { return frame % (std::uint64_t)mode().renderEvery == 0; }
+    bool color() const { return mode().color; }
+    const Mode& mode() const;
+    int level() const { return level_; }
+
+    // 一次 present() 结束后调用；tickMs 为逻辑帧的时长
+    void record(const PresentCost& cost, double tickMs);
+
+    double flushMs() const { return flushMs_; }
+    double bytesPerFrame() const { return bytes_; }
+    // 饱和期间估计的链路吞吐（字节/秒）；回到最高档后清零，表示未测得上限。
+    // 后端只报格数时（PresentCost::cells）这两项的单位是格
+    double throughput() const { return throughput_; }
+
+    // 调试浮层的一行文字：当前档位、吞吐、每帧输出耗时、字节数（或格数）与积压；写入 out，不分配内存
+    void describe(char* out, std::size_t size) const;
+
+private:
+    static constexpr double kSmoothing = 0.25;      // 指数滑动平均的权重
+    static constexpr double kDegradeShare = 0.5;    // 输出耗时超过绘制间隔的这一比例即算饱和
+    static constexpr double kRecoverShare = 0.2;    // 低于上一档绘制间隔的这一比例才算有余量
+    static constexpr int kDegradeFrames = 4;        // 连续这么多次饱和才降级，偶发抖动不降
+    static constexpr double kRecoverMs = 1000;      // 有余量持续这么久才试探升级
+    static constexpr double kMaxRecoverMs = 16000;  // 升级失败后等待时间加倍的上限
+    static constexpr double kSettledMs = 10000;     // 一个档位保持这么久，等待时间恢复初值
+
+    void change(int level);
+
+    int level_ = 0;
+    bool raised_ = false;  // 最近一次换档是升级
+    double flushMs_ = 0;   // 滑动平均
+    double bytes_ = 0;
+    double rateBytes_ = 0; // 饱和期间的累计字节与时间（带衰减）
+    double rateMs_ = 0;
+    double throughput_ = 0;
+    std::size_t backlog_ = 0;
+    bool cells_ = false;   // 最近一次 present() 报的是格数
+    int saturated_ = 0;
+    double spareMs_ = 0;
+    double sinceChangeMs_ = 0;
+    double recoverMs_ = kRecoverMs;
+};
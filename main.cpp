@@ -1,13 +1,275 @@
 #include "game.h"
+#include "arcade_client.h"
+#include "arcade_server.h"
+#include "archetypes.h"
+#include "island_generator.h"
+#include "snapshot_inspector.h"
+#include "event_csv.h"
+#include "scenario_check.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <string>
+#include <vector>
 
-int main(int argc, char** argv) {
-    std::string mapPath;
-    if (argc >= 2) {
-        mapPath = argv[1];
+namespace {
+
+struct CommandLine {
+    GameOptions options;
+    std::string archetypesPath = "archetypes.txt";
+    bool archetypesExplicit = false;
+    bool renderExplicit = false;
+    std::string generateSize;
+    std::string tracePath;  // --trace：把每帧的状态哈希写入此文件
+    std::string goldenDir;  // --check-golden：逐个重放目录下的金标准轨迹
+    bool checkScenarios = false; // --check-scenarios：跑内置的规则自检场景
+    std::string servePath;  // --serve：以服务器模式在此 Unix 套接字上托管多个会话
+    std::string connectPath; // --connect：作为瘦客户端接入服务器
+    int workers = 0;        // --workers：服务器工作线程数（0 = 全部核心）
+    std::string inspectName; // --inspect：读取另一个游戏进程发布的快照环并打印
+    std::string eventsCsvPath; // --events-csv：把事件日志转成 CSV 输出
+};
+
+bool parseArgs(const std::vector<std::string>& args, CommandLine* cl, std::string* error) {
+    GameOptions& options = cl->options;
+    const std::size_t n = args.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::string& arg = args[i];
+        if (arg == "--autopilot") {
+            options.autopilot = true;
+        } else if (arg == "--survival") {
+            options.survival = true;
+        } else if (arg == "--fog") {
+            options.fog = true;
+        } else if (arg == "--alloc-check") {
+            options.allocCheck = true;
+        } else if (arg == "--overlay") {
+            options.overlay = true;
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else if (arg == "--archetypes" && i + 1 < n) {
+            cl->archetypesPath = args[++i];
+            cl->archetypesExplicit = true;
+        } else if (arg == "--render" && i + 1 < n) {
+            const std::string& name = args[++i];
+            if (!parseRenderBackend(name, &options.render)) {
+                *error = "unknown render backend: " + name + " (expected ncurses, ansi or memory)";
+                return false;
+            }
+            cl->renderExplicit = true;
+        } else if (arg == "--frames" && i + 1 < n) {
+            options.maxFrames = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < n) {
+            options.seed = (std::uint32_t)std::strtoul(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--density" && i + 1 < n) {
+            options.density = std::atoi(args[++i].c_str());
+        } else if (arg == "--generate" && i + 1 < n) {
+            cl->generateSize = args[++i];
+        } else if (arg == "--trace" && i + 1 < n) {
+            cl->tracePath = args[++i];
+        } else if (arg == "--check-golden" && i + 1 < n) {
+            cl->goldenDir = args[++i];
+        } else if (arg == "--check-scenarios") {
+            cl->checkScenarios = true;
+        } else if (arg == "--serve" && i + 1 < n) {
+            cl->servePath = args[++i];
+        } else if (arg == "--connect" && i + 1 < n) {
+            cl->connectPath = args[++i];
+        } else if (arg == "--workers" && i + 1 < n) {
+            cl->workers = std::atoi(args[++i].c_str());
+        } else if (arg == "--snapshots" && i + 1 < n) {
+            options.snapshotName = args[++i];
+        } else if (arg == "--inspect" && i + 1 < n) {
+            cl->inspectName = args[++i];
+        } else if (arg == "--events" && i + 1 < n) {
+            options.eventLogPath = args[++i];
+        } else if (arg == "--events-csv" && i + 1 < n) {
+            cl->eventsCsvPath = args[++i];
+        } else {
+            options.mapFilePath = arg;
+        }
     }
 
-    Game game(mapPath);
-    game.runLoop();
+    // 基准：自动驾驶 + 不限速；默认画到内存、跑 3600 帧
+    if (options.bench) {
+        options.autopilot = true;
+        if (!cl->renderExplicit) options.render = RenderBackend::MEMORY;
+        if (options.maxFrames == 0) options.maxFrames = 3600;
+    }
+    return true;
+}
+
+// 只生成一张 RxC 的岛屿地图并计时（不启动游戏），用于检查生成器性能
+int generateOnly(const CommandLine& cl) {
+    int rows = 0;
+    int cols = 0;
+    if (std::sscanf(cl.generateSize.c_str(), "%dx%d", &rows, &cols) != 2 || rows <= 0 || cols <= 0) {
+        std::cerr << "bad --generate size: " << cl.generateSize << " (expected RxC, e.g. 4096x4096)" << std::endl;
+        return 1;
+    }
+    IslandParams params;
+    params.seed = cl.options.seed != 0 ? cl.options.seed : 1;
+    params.density = cl.options.density;
+    std::vector<std::uint64_t> bits;
+    IslandStats islandStats;
+    const auto start = std::chrono::steady_clock::now();
+    generateIslands(params, rows, cols, bits, &islandStats);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::uint64_t land = 0;
+    for (std::uint64_t word : bits) land += (std::uint64_t)__builtin_popcountll(word);
+    std::printf("%dx%d seed %u density %d: %.2f ms  land %.1f%%  water regions %d  filled lakes %d  channels %d\n",
+                rows, cols, params.seed, params.density, ms, 100.0 * (double)land / ((double)rows * cols),
+                islandStats.waterRegions, islandStats.filledLakes, islandStats.channels);
     return 0;
 }
+
+// 重放 dir 下每个 .trace 文件记录的场景，与其中的哈希逐帧比对；有任何分歧返回 1
+int checkGolden(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == ".trace") paths.push_back(entry.path().string());
+    }
+    if (ec || paths.empty()) {
+        std::cerr << dir << ": no .trace files" << std::endl;
+        return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    int failures = 0;
+    for (const std::string& path : paths) {
+        Trace golden;
+        std::string error;
+        CommandLine cl;
+        if (!loadTrace(path, &golden, &error) || !parseArgs(golden.args, &cl, &error)) {
+            std::printf("%s: %s\n", path.c_str(), error.c_str());
+            ++failures;
+            continue;
+        }
+        cl.options.trace = true;
+        cl.options.render = RenderBackend::MEMORY;
+
+        std::vector<std::uint64_t> actual;
+        {
+            Game game(cl.options);
+            game.runLoop();
+            actual = game.trace();
+        }
+
+        const long tick = firstDivergence(golden.hashes, actual);
+        if (tick < 0) {
+            std::printf("%s: ok (%zu ticks)\n", path.c_str(), actual.size());
+            continue;
+        }
+        ++failures;
+        if ((std::size_t)tick < golden.hashes.size() && (std::size_t)tick < actual.size()) {
+            std::printf("%s: diverges at tick %ld: expected %016llx, got %016llx\n", path.c_str(), tick,
+                        (unsigned long long)golden.hashes[tick], (unsigned long long)actual[tick]);
+        } else {
+            std::printf("%s: length differs at tick %ld: expected %zu ticks, got %zu\n", path.c_str(), tick,
+                        golden.hashes.size(), actual.size());
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    CommandLine cl;
+    std::string error;
+    if (!parseArgs(args, &cl, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    GameOptions& options = cl.options;
+
+    if (!cl.generateSize.empty()) return generateOnly(cl);
+    if (!cl.connectPath.empty()) return runArcadeClient(cl.connectPath);
+    if (!cl.inspectName.empty()) return runSnapshotInspector(cl.inspectName);
+
+    // 原型表：默认读取当前目录的 archetypes.txt；不存在时使用内置默认表
+    if ((cl.archetypesExplicit || std::ifstream(cl.archetypesPath).good()) && !loadArchetypes(cl.archetypesPath, &error)) {
+        std::cerr << cl.archetypesPath << ": " << error << " (using built-in archetypes)" << std::endl;
+    }
+
+    if (!cl.goldenDir.empty()) return checkGolden(cl.goldenDir);
+    if (cl.checkScenarios) return checkScenarios();
+    if (!cl.eventsCsvPath.empty()) return runEventCsv(cl.eventsCsvPath); // 舰种名用上面加载的原型表
+
+    if (!cl.servePath.empty()) {
+        ArcadeOptions arcade;
+        arcade.socketPath = cl.servePath;
+        arcade.workers = cl.workers;
+        arcade.game = options;
+        ArcadeServer server(arcade);
+        return server.run();
+    }
+
+    if (!cl.tracePath.empty()) {
+        if (options.seed == 0 || options.maxFrames == 0) {
+            std::cerr << "--trace needs --seed and --frames (or --bench) so the run can be replayed" << std::endl;
+            return 1;
+        }
+        options.trace = true;
+    }
+
+    FrameStats stats;
+    int tickRate = 0;
+    bool allocFailed = false;
+    std::vector<std::uint64_t> hashes;
+    {
+        Game game(options);
+        game.runLoop();
+        stats = game.stats();
+        tickRate = game.tickRate();
+        allocFailed = game.allocFailed();
+        hashes = game.trace();
+    }
+
+    // 轨迹只记录模拟相关的参数，便于 --check-golden 原样重放
+    if (!cl.tracePath.empty()) {
+        Trace trace;
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            if (args[i] == "--trace" || args[i] == "--render" || args[i] == "--snapshots" || args[i] == "--events") {
+                ++i;
+                continue;
+            }
+            trace.args.push_back(args[i]);
+        }
+        trace.hashes = std::move(hashes);
+        if (!saveTrace(cl.tracePath, trace)) {
+            std::cerr << cl.tracePath << ": cannot write trace" << std::endl;
+            return 1;
+        }
+    }
+
+    // 终端已恢复后再输出统计
+    if (options.bench && stats.frames > 0) {
+        std::printf("frames %llu  avg %.3f ms  p50 %.1f ms  p99 %.1f ms  max %.3f ms\n",
+                    (unsigned long long)stats.frames, stats.totalMs / (double)stats.frames,
+                    stats.percentile(0.50), stats.percentile(0.99), stats.maxMs);
+        std::printf("over %d Hz budget: %llu frames  peak enemies %zu  peak projectiles %zu  peak particles %zu\n",
+                    tickRate, (unsigned long long)stats.overBudget, stats.peakEnemies, stats.peakProjectiles,
+                    stats.peakParticles);
+        std::printf("allocs %llu (%.1f KB)  avg %.2f/frame  max %llu/frame  frames with allocs %llu\n",
+                    (unsigned long long)stats.allocs, (double)stats.allocBytes / 1024.0,
+                    (double)stats.allocs / (double)stats.frames, (unsigned long long)stats.maxFrameAllocs,
+                    (unsigned long long)stats.allocFrames);
+        std::printf("allocs by phase:");
+        for (int i = 0; i < (int)AllocPhase::COUNT; ++i) {
+            const AllocCounts& c = stats.phaseAllocs[i];
+            if (c.count == 0) continue;
+            std::printf("  %s %llu (%.1f KB)", allocPhaseName((AllocPhase)i), (unsigned long long)c.count,
+                        (double)c.bytes / 1024.0);
+        }
+        std::printf("\n");
+    }
+    return allocFailed ? 1 : 0;
+}
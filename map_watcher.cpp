@@ -0,0 +1,57 @@
+#include "map_watcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+
+MapWatcher::~MapWatcher() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool MapWatcher::watch(const std::string& path) {
+    const std::size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    fileName_ = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) return false;
+    wd_ = inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd_ < 0) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool MapWatcher::changed() {
+    if (fd_ < 0) return false;
+
+    // 一次把积压的事件读完，同一帧内的多次写入只算一次变化
+    alignas(inotify_event) char buf[4096];
+    bool hit = false;
+    while (true) {
+        const ssize_t n = read(fd_, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (ssize_t off = 0; off < n;) {
+            const inotify_event* ev = reinterpret_cast<const inotify_event*>(buf + off);
+            if (ev->len > 0 && fileName_ == ev->name) hit = true;
+            off += (ssize_t)(sizeof(inotify_event) + ev->len);
+        }
+    }
+    return hit;
+}
+
+#else
+
+MapWatcher::~MapWatcher() {}
+
+bool MapWatcher::watch(const std::string&) {
+    return false;
+}
+
+bool MapWatcher::changed() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+
+// 监视地图文件的变化（Linux 上用 inotify）。
+// 监视的是文件所在目录：编辑器常用“写临时文件再改名”的方式保存，直接监视文件会丢失后续事件。
+// 其它平台上 changed() 始终返回 false。
+class MapWatcher {
+public:
+    MapWatcher() = default;
+    ~MapWatcher();
+    MapWatcher(const MapWatcher&) = delete;
+    MapWatcher& operator=(const MapWatcher&) = delete;
+
+    // 开始监视 path；失败时返回 false（之后 changed() 始终为 false）
+    bool watch(const std::string& path);
+
+    // 不阻塞：自上次调用以来文件是否被写入 / 替换
+    bool changed();
+
+private:
+    int fd_ = -1;
+    int wd_ = -1;
+    std::string fileName_;
+};
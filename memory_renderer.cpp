@@ -0,0 +1,11 @@
+#include "memory_renderer.h"
+
+std::string MemoryRenderer::text() const {
+    std::string out;
+    out.reserve((std::size_t)screenRows_ * (screenCols_ + 1));
+    for (int r = 0; r < screenRows_; ++r) {
+        for (int c = 0; c < screenCols_; ++c) out.push_back(cellAt(r, c).ch);
+        out.push_back('\n');
+    }
+    return out;
+}
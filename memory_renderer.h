@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "renderer.h"
+
+// 内存后端：不接触终端，present() 只计数。用于测试、基准与无终端运行。
+class MemoryRenderer : public Renderer {
+public:
+    MemoryRenderer(int rows, int cols) : Renderer(rows, cols) {}
+
+    void present() override { ++frames_; }
+
+    std::uint64_t frames() const { return frames_; }
+    char charAt(int screenRow, int screenCol) const { return cellAt(screenRow, screenCol).ch; }
+    int colorAt(int screenRow, int screenCol) const { return cellAt(screenRow, screenCol).color; }
+    // 当前画面的纯文本（每行以 '\n' 结尾）
+    std::string text() const;
+
+private:
+    std::uint64_t frames_ = 0;
+};
@@ -0,0 +1,71 @@
+#include "minimap.h"
+#include "archetypes.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int kRed = 2; // 颜色编号见 archetypes.h
+
+} // namespace
+
+void Minimap::draw(Renderer& renderer, const World& world, const GameRegistry& reg, EntityId player,
+                   const FieldOfView* fog) {
+    if (world.rows() <= World::kDefaultRows && world.cols() <= World::kDefaultCols) return;
+
+    int level = 1;
+    while (level < World::kPyramidLevels &&
+           (world.blockRows(level) > kMaxRows || world.blockCols(level) > kMaxCols)) {
+        ++level;
+    }
+    const int rows = std::min(world.blockRows(level), kMaxRows);
+    const int cols = std::min(world.blockCols(level), kMaxCols);
+
+    // 敌舰按所在块计数（以外形左上角为准）
+    enemies_.assign((std::size_t)rows * cols, 0);
+    const EnemyTable& enemies = reg.table<EnemyTable>();
+    const std::vector<Position>& pos = enemies.column<Position>();
+    const std::vector<Footprint>& fp = enemies.column<Footprint>();
+    for (std::size_t r = 0; r < enemies.size(); ++r) {
+        if (enemies.isDead(r) || !world.inBounds(pos[r].row, pos[r].col)) continue;
+        if (fog && !fog->anyVisible(pos[r].row, pos[r].col, shapeOf(fp[r].shape))) continue;
+        const int br = pos[r].row >> level;
+        const int bc = pos[r].col >> level;
+        if (br < rows && bc < cols) enemies_[(std::size_t)br * cols + bc]++;
+    }
+
+    // 带边框，右上角贴住游戏区的边框
+    const int top = 2;
+    const int left = renderer.screenCols() - 1 - (cols + 2);
+    for (int c = 0; c < cols + 2; ++c) {
+        const char ch = (c == 0 || c == cols + 1) ? '+' : '-';
+        renderer.drawCell(top, left + c, ch, 0);
+        renderer.drawCell(top + rows + 1, left + c, ch, 0);
+    }
+    const int side = 1 << level;
+    for (int br = 0; br < rows; ++br) {
+        renderer.drawCell(top + 1 + br, left, '|', 0);
+        renderer.drawCell(top + 1 + br, left + cols + 1, '|', 0);
+        for (int bc = 0; bc < cols; ++bc) {
+            char ch = ' ';
+            int color = 0;
+            const int count = enemies_[(std::size_t)br * cols + bc];
+            if (count > 0) {
+                ch = count > 9 ? '*' : (char)('0' + count);
+                color = kRed;
+            } else {
+                // 块伸出地图的部分不算面积
+                const int area = (std::min(side, world.rows() - br * side)) * (std::min(side, world.cols() - bc * side));
+                const int blocked = world.blockCount(level, br, bc);
+                if (blocked * 2 >= area) ch = '#';
+                else if (blocked * 4 >= area) ch = ':';
+                else if (blocked > 0) ch = '.';
+            }
+            renderer.drawCell(top + 1 + br, left + 1 + bc, ch, color);
+        }
+    }
+
+    const Position& p = *reg.get<Position>(player);
+    const int pr = p.row >> level;
+    const int pc = p.col >> level;
+    if (pr < rows && pc < cols) renderer.drawCell(top + 1 + pr, left + 1 + pc, '@', archetypes().playerColor);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "components.h"
+#include "field_of_view.h"
+#include "renderer.h"
+#include "world.h"
+
+// 小地图：地图比视口大时（生存模式）画在游戏区右上角、HUD 的正下方。
+// 每个小地图格对应地图上一个对齐的 2^level × 2^level 块，level 取能放进 kMaxRows × kMaxCols 的最低一层：
+// 地形直接取 World 障碍金字塔上该块的计数，按密度画成 . : #；敌舰按块计数（1..9，更多画 *），玩家画 @。
+// 每次绘制只读金字塔的一层，与地图大小无关。
+class Minimap {
+public:
+    static constexpr int kMaxRows = 10;
+    static constexpr int kMaxCols = 40;
+
+    // fog 非空时视野外的敌舰不计入
+    void draw(Renderer& renderer, const World& world, const GameRegistry& reg, EntityId player,
+              const FieldOfView* fog);
+
+private:
+    std::vector<std::uint16_t> enemies_; // 每个小地图格里的敌舰数，尺寸变了才重新分配
+};
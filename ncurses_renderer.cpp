@@ -0,0 +1,44 @@
+#include "ncurses_renderer.h"
+#include <chrono>
+#include <ncurses.h>
+#include "archetypes.h"
+
+NcursesRenderer::NcursesRenderer(int rows, int cols)
+    : Renderer(rows, cols), shown_(screenRows_ * screenCols_, Cell{'\0', 0}) {
+    initscr();
+    cbreak();
+    noecho();
+    keypad(stdscr, TRUE);
+    nodelay(stdscr, TRUE);
+    curs_set(0);
+    start_color();
+
+    // 颜色编号 = 1 + 前景色（见 archetypes.h），由原型表引用
+    for (int i = 0; i < kColorCount; ++i) {
+        init_pair(i + 1, i, COLOR_BLACK);
+    }
+}
+
+NcursesRenderer::~NcursesRenderer() {
+    endwin();
+}
+
+void NcursesRenderer::present() {
+    // ncurses 自己拼控制序列，拿不到确切的字节数，改报交出去的格数
+    std::size_t changed = 0;
+    for (int r = 0; r < screenRows_; ++r) {
+        for (int c = 0; c < screenCols_; ++c) {
+            const Cell& cell = cellAt(r, c);
+            Cell& shown = shown_[r * screenCols_ + c];
+            if (cell == shown) continue;
+            shown = cell;
+            mvaddch(r, c, (chtype)(unsigned char)cell.ch | (cell.color > 0 ? COLOR_PAIR(cell.color) : 0));
+            ++changed;
+        }
+    }
+    const auto start = std::chrono::steady_clock::now();
+    refresh();
+    lastPresent_.bytes = changed;
+    lastPresent_.cells = true;
+    lastPresent_.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
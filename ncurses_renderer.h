@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include "renderer.h"
+
+// ncurses 后端：present() 只把与上一帧不同的格子交给 ncurses，再 refresh()；
+// 输出开销按交出的格数与 refresh() 的耗时记录
+class NcursesRenderer : public Renderer {
+public:
+    NcursesRenderer(int rows, int cols);
+    ~NcursesRenderer() override;
+
+    void present() override;
+
+private:
+    std::vector<Cell> shown_; // 上一次 present() 送出的内容
+};
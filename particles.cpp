@@ -0,0 +1,165 @@
+#include "particles.h"
+#include <algorithm>
+
+namespace {
+
+// 16 个方向的单位向量（×16 取整），爆炸与火花沿这些方向散开
+constexpr std::int8_t kDirRow[16] = {0, 6, 11, 15, 16, 15, 11, 6, 0, -6, -11, -15, -16, -15, -11, -6};
+constexpr std::int8_t kDirCol[16] = {16, 15, 11, 6, 0, -6, -11, -15, -16, -15, -11, -6, 0, 6, 11, 15};
+
+// 颜色编号见 archetypes.h：1 + ANSI 前景色
+constexpr int kRed = 2;
+constexpr int kYellow = 4;
+constexpr int kBlue = 5;
+constexpr int kCyan = 7;
+constexpr int kWhite = 8;
+
+} // namespace
+
+ParticleSystem::ParticleSystem()
+    : rng_(0x5eed) {
+}
+
+void ParticleSystem::allocate() {
+    if (!life_.empty()) return;
+    row_.resize(kCapacity);
+    col_.resize(kCapacity);
+    vRow_.resize(kCapacity);
+    vCol_.resize(kCapacity);
+    life_.assign(kCapacity, 0);
+    kind_.assign(kCapacity, 0);
+}
+
+void ParticleSystem::clear() {
+    std::fill(life_.begin(), life_.end(), 0);
+    tail_ = 0;
+    count_ = 0;
+}
+
+void ParticleSystem::emit(int row, int col, int vRow, int vCol, int life, Kind kind) {
+    if (life_.empty()) return; // 还没开局（没分配）
+    std::size_t i = tail_ + count_;
+    if (i >= (std::size_t)kCapacity) i -= kCapacity;
+    if (count_ == (std::size_t)kCapacity) {
+        // 满了：覆盖最老的粒子
+        tail_ = tail_ + 1 == (std::size_t)kCapacity ? 0 : tail_ + 1;
+    } else {
+        ++count_;
+    }
+    row_[i] = row * kSub + kSub / 2;
+    col_[i] = col * kSub + kSub / 2;
+    vRow_[i] = (std::int16_t)vRow;
+    vCol_[i] = (std::int16_t)vCol;
+    life_[i] = (std::uint8_t)life;
+    kind_[i] = kind;
+}
+
+void ParticleSystem::update() {
+    // 环上的一段最多分成两截连续的下标，各自一个紧凑的循环
+    auto step = [this](std::size_t begin, std::size_t end) {
+        std::int32_t* row = row_.data();
+        std::int32_t* col = col_.data();
+        std::int16_t* vRow = vRow_.data();
+        std::int16_t* vCol = vCol_.data();
+        std::uint8_t* life = life_.data();
+        for (std::size_t i = begin; i < end; ++i) {
+            if (life[i] == 0) continue;
+            --life[i];
+            row[i] += vRow[i];
+            col[i] += vCol[i];
+            // 水的阻力：每帧减速 1/8
+            vRow[i] = (std::int16_t)(vRow[i] - vRow[i] / 8);
+            vCol[i] = (std::int16_t)(vCol[i] - vCol[i] / 8);
+        }
+    };
+    const std::size_t end = tail_ + count_;
+    if (end <= (std::size_t)kCapacity) {
+        step(tail_, end);
+    } else {
+        step(tail_, kCapacity);
+        step(0, end - kCapacity);
+    }
+
+    while (count_ > 0 && life_[tail_] == 0) {
+        tail_ = tail_ + 1 == (std::size_t)kCapacity ? 0 : tail_ + 1;
+        --count_;
+    }
+    if (count_ == 0) tail_ = 0;
+}
+
+void ParticleSystem::explode(int row, int col, int size) {
+    // 火焰：慢速向外扩散；碎片：飞得更远、更久。终端字符约 2:1 的高宽比，横向速度加倍
+    const int flames = std::min(8 + 4 * size, 96);
+    const int debris = std::min(2 + size, 24);
+    const int reach = std::min(2 + size / 4, 8);
+    for (int i = 0; i < flames; ++i) {
+        const int dir = rng_.below(16);
+        const int speed = 1 + rng_.below(reach);
+        emit(row, col, kDirRow[dir] * speed / 4, kDirCol[dir] * speed / 2, 6 + rng_.below(7), FLAME);
+    }
+    for (int i = 0; i < debris; ++i) {
+        const int dir = rng_.below(16);
+        const int speed = reach + rng_.below(reach);
+        emit(row, col, kDirRow[dir] * speed / 4, kDirCol[dir] * speed / 2, 8 + rng_.below(9), DEBRIS);
+    }
+}
+
+void ParticleSystem::spark(int row, int col) {
+    for (int i = 0; i < 3; ++i) {
+        const int dir = rng_.below(16);
+        emit(row, col, kDirRow[dir] / 2, kDirCol[dir], 2 + rng_.below(3), SPARK);
+    }
+}
+
+void ParticleSystem::wake(int row, int col) {
+    // 略微向两侧漂开
+    const int drift = rng_.below(5) - 2;
+    emit(row, col, drift, drift * 2, 6 + rng_.below(5), WAKE);
+}
+
+void ParticleSystem::flash(int row, int col, int dRow, int dCol) {
+    emit(row, col, 0, 0, 2, FLASH);
+    emit(row, col, dRow * kSub / 2, dCol * kSub, 2 + rng_.below(2), FLASH);
+}
+
+void ParticleSystem::draw(Renderer& renderer) const {
+    auto drawRange = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const int life = life_[i];
+            if (life == 0) continue;
+            char ch = '.';
+            int color = 0;
+            switch (kind_[i]) {
+                case FLAME:
+                    ch = life > 6 ? '*' : (life > 2 ? '+' : '.');
+                    color = life > 6 ? kYellow : kRed;
+                    break;
+                case DEBRIS:
+                    ch = life > 4 ? '\'' : ',';
+                    color = kWhite;
+                    break;
+                case SPARK:
+                    ch = life > 1 ? '+' : '.';
+                    color = kYellow;
+                    break;
+                case WAKE:
+                    ch = life > 3 ? '~' : '.';
+                    color = life > 3 ? kCyan : kBlue;
+                    break;
+                case FLASH:
+                    ch = life > 1 ? '*' : '+';
+                    color = life > 1 ? kWhite : kYellow;
+                    break;
+            }
+            // 定点坐标右移即向下取整，负坐标也一样
+            renderer.drawEffect(row_[i] >> kSubShift, col_[i] >> kSubShift, ch, color);
+        }
+    };
+    const std::size_t end = tail_ + count_;
+    if (end <= (std::size_t)kCapacity) {
+        drawRange(tail_, end);
+    } else {
+        drawRange(tail_, kCapacity);
+        drawRange(0, end - kCapacity);
+    }
+}
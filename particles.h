@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+#include "rng.h"
+
+// 特效层：舰船被击毁时的爆炸、鱼雷航迹、开火的炮口焰与命中火花。
+// 纯视觉，不参与模拟：不用 gameRng()、不计入状态哈希，开不开都不影响逐帧复现。
+// 粒子存在定长的环形缓冲区里（结构数组，第一次开局时一次分配，停在菜单的会话不占这块内存），发射总是写在队头，
+// 满了就覆盖最老的粒子；每帧在“最老的存活粒子 .. 队头”这一段上一个循环更新完。
+// 寿命都很短，最老的粒子也最先熄灭，覆盖掉的通常已经熄灭或即将熄灭。
+class ParticleSystem {
+public:
+    static constexpr int kCapacity = 1 << 16;
+
+    ParticleSystem();
+
+    // 分配环形缓冲区（已分配则什么也不做）；之前发射的粒子直接丢弃
+    void allocate();
+    // 换关 / 地图变了：粒子全部作废
+    void clear();
+    // 推进一帧：移动、扣寿命，并把队尾已经熄灭的粒子让出来
+    void update();
+
+    // 以 (row, col) 为中心的爆炸；size 为舰船外形的格数，越大碎片越多、飞得越远
+    void explode(int row, int col, int size);
+    // 命中火花
+    void spark(int row, int col);
+    // 航迹：留在投射物身后、慢慢散开的水花
+    void wake(int row, int col);
+    // 炮口焰：(dRow, dCol) 为开火方向
+    void flash(int row, int col, int dRow, int dCol);
+
+    // 画到海面上：只覆盖空白的海面格，不盖住舰船、岛屿与迷雾
+    void draw(Renderer& renderer) const;
+
+    // 当前存活的粒子数（环中仍在更新的段长，含段内已熄灭的空位）
+    std::size_t live() const { return count_; }
+
+private:
+    enum Kind : std::uint8_t { FLAME, DEBRIS, SPARK, WAKE, FLASH };
+    static constexpr int kSubShift = 4;
+    static constexpr int kSub = 1 << kSubShift; // 位置与速度的定点单位：1 格 = 16
+
+    void emit(int row, int col, int vRow, int vCol, int life, Kind kind);
+
+    // 结构数组，下标按环取模
+    std::vector<std::int32_t> row_;
+    std::vector<std::int32_t> col_;
+    std::vector<std::int16_t> vRow_;
+    std::vector<std::int16_t> vCol_;
+    std::vector<std::uint8_t> life_; // 剩余帧数，0 为已熄灭
+    std::vector<std::uint8_t> kind_;
+    std::size_t tail_ = 0;  // 最老的粒子
+    std::size_t count_ = 0; // tail_ 起的段长
+    Rng rng_;               // 特效自己的随机数，不动游戏的随机数序列
+};
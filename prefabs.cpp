@@ -0,0 +1,65 @@
+#include "prefabs.h"
+
+ShapeId playerShape(bool vertical) {
+    static const ShapeId kVertical = internShape(" ^\n \"\n V");
+    static const ShapeId kHorizontal = internShape("<=>");
+    return vertical ? kVertical : kHorizontal;
+}
+
+EntityId spawnPlayer(GameRegistry& reg, int row, int col) {
+    return reg.create<PlayerTable>(
+        Position{row, col},
+        Footprint{playerShape(true)},
+        Health{1000, 1000},
+        Ammo{100, 0, 5},
+        Color{archetypes().playerColor},
+        PlayerState{});
+}
+
+EntityId spawnEnemy(GameRegistry& reg, int row, int col, EnemyType type, int dir) {
+    const ArchetypeTable& t = archetypes();
+    dir = (dir >= 0) ? 1 : -1;
+    return reg.create<EnemyTable>(
+        Position{row, col},
+        Footprint{dir > 0 ? t.shapeRight[type] : t.shapeLeft[type]}, // Facing based on direction
+        Health{t.hp[type], t.hp[type]},
+        Ammo{t.shells[type], t.torpedoes[type], t.missiles[type]},
+        AiTimers{0, 0, t.moveInterval[type], t.fireInterval[type]},
+        Color{t.color[type]},
+        EnemyInfo{type, dir});
+}
+
+EntityId spawnProjectile(GameRegistry& reg, int row, int col, int dRow, int dCol, ProjectileType type, Side side) {
+    const ArchetypeTable& t = archetypes();
+    const int idx = (int)type;
+    ProjectileInfo info;
+    info.type = type;
+    info.side = side;
+    info.prevRow = row;
+    info.prevCol = col;
+    return reg.create<ProjectileTable>(
+        Position{row, col},
+        Footprint{dCol == 0 ? t.projectileShapeV[idx] : t.projectileShapeH[idx]},
+        Velocity{dRow, dCol},
+        Color{t.projectileColor[idx]},
+        info);
+}
+
+ShapeId pickupShape(PickupType type) {
+    static const ShapeId kWeapon = internShape("W");
+    static const ShapeId kMedical = internShape("+");
+    return type == PickupType::WEAPON ? kWeapon : kMedical;
+}
+
+void internPrefabShapes() {
+    playerShape(true);
+    pickupShape(PickupType::WEAPON);
+}
+
+EntityId spawnPickup(GameRegistry& reg, int row, int col, PickupType type) {
+    return reg.create<PickupTable>(
+        Position{row, col},
+        Footprint{pickupShape(type)},
+        Color{archetypes().pickupColor},
+        PickupInfo{type});
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "components.h"
+
+// 各类实体的初始组件（对应原来各个子类的构造函数）
+
+ShapeId playerShape(bool vertical);
+ShapeId pickupShape(PickupType type);
+// 外形在第一次用到时登记；多线程运行（服务器）之前调用一次，之后各线程只读外形库
+void internPrefabShapes();
+
+EntityId spawnPlayer(GameRegistry& reg, int row, int col);
+EntityId spawnEnemy(GameRegistry& reg, int row, int col, EnemyType type, int dir = 1);
+EntityId spawnProjectile(GameRegistry& reg, int row, int col, int dRow, int dCol, ProjectileType type, Side side);
+EntityId spawnPickup(GameRegistry& reg, int row, int col, PickupType type);
@@ -1,115 +1,141 @@
 #include "renderer.h"
-#include <sstream>
-#include <vector>
-
-Renderer::Renderer(int rows, int cols) : rows_(rows), cols_(cols) {
-    initscr();
-    cbreak();
-    noecho();
-    keypad(stdscr, TRUE);
-    nodelay(stdscr, TRUE);
-    curs_set(0);
-    start_color();
-    
-    init_pair(1, COLOR_GREEN, COLOR_BLACK);   // Player
-    init_pair(2, COLOR_YELLOW, COLOR_BLACK);  // Gunboat
-    init_pair(3, COLOR_RED, COLOR_BLACK);     // Destroyer
-    init_pair(4, COLOR_MAGENTA, COLOR_BLACK); // Cruiser
-    init_pair(5, COLOR_CYAN, COLOR_BLACK);    // Bomber
-    init_pair(6, COLOR_WHITE, COLOR_BLACK);   // Projectile
-    init_pair(7, COLOR_BLUE, COLOR_BLACK);    // Pickup
+#include "ncurses_renderer.h"
+#include "ansi_renderer.h"
+#include "memory_renderer.h"
+#include <cstring>
+
+bool parseRenderBackend(const std::string& name, RenderBackend* out) {
+    if (name == "ncurses") {
+        *out = RenderBackend::NCURSES;
+    } else if (name == "ansi") {
+        *out = RenderBackend::ANSI;
+    } else if (name == "memory") {
+        *out = RenderBackend::MEMORY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Renderer> makeRenderer(RenderBackend backend, int rows, int cols, int fd) {
+    switch (backend) {
+        case RenderBackend::ANSI:
+            return std::make_unique<AnsiRenderer>(rows, cols, fd >= 0 ? fd : STDOUT_FILENO);
+        case RenderBackend::MEMORY:
+            return std::make_unique<MemoryRenderer>(rows, cols);
+        case RenderBackend::NCURSES:
+            break;
+    }
+    return std::make_unique<NcursesRenderer>(rows, cols);
+}
+
+Renderer::Renderer(int rows, int cols)
+    : rows_(rows), cols_(cols), screenRows_(rows + 3), screenCols_(cols + 2),
+      cells_(screenRows_ * screenCols_) {
 }
 
-Renderer::~Renderer() {
-    endwin();
+void Renderer::put(int screenRow, int screenCol, char ch, int color) {
+    if (screenRow < 0 || screenRow >= screenRows_) return;
+    if (screenCol < 0 || screenCol >= screenCols_) return;
+    Cell& cell = cells_[screenRow * screenCols_ + screenCol];
+    cell.ch = ch;
+    cell.color = monochrome_ ? 0 : (std::uint8_t)color;
 }
 
 void Renderer::clear() {
-    ::clear();
+    for (Cell& cell : cells_) cell = Cell{};
 }
 
 void Renderer::drawBorders() {
     for (int c = 0; c <= cols_ + 1; ++c) {
-        mvaddch(1, c, '-');
-        mvaddch(rows_ + 2, c, '-');
+        put(1, c, '-', 0);
+        put(rows_ + 2, c, '-', 0);
     }
     for (int r = 1; r <= rows_ + 2; ++r) {
-        mvaddch(r, 0, '|');
-        mvaddch(r, cols_ + 1, '|');
+        put(r, 0, '|', 0);
+        put(r, cols_ + 1, '|', 0);
     }
 }
 
-void Renderer::drawWorld(const World& world) {
-    for (int r = 0; r < World::kRows; ++r) {
-        for (int c = 0; c < World::kCols; ++c) {
-            if (world.isBlocked(r, c)) {
-                mvaddch(r + 2, c + 1, '#');
+void Renderer::drawWorld(const World& world, const FieldOfView* fog) {
+    for (int r = 0; r < rows_; ++r) {
+        for (int c = 0; c < cols_; ++c) {
+            const int wr = cameraRow_ + r;
+            const int wc = cameraCol_ + c;
+            if (!world.inBounds(wr, wc)) continue;
+            if (world.isBlocked(wr, wc)) {
+                put(r + 2, c + 1, '#', 0); // 海图上的岛屿始终已知
+            } else if (fog && !fog->visible(wr, wc)) {
+                put(r + 2, c + 1, '.', 0);
             }
         }
     }
 }
 
-void Renderer::drawHud(const std::string &status) {
-    mvaddnstr(0, 0, status.c_str(), cols_);
+void Renderer::drawHud(const char* status) {
+    const int len = (int)std::strlen(status);
+    const int n = len < cols_ ? len : cols_;
+    for (int i = 0; i < n; ++i) put(0, i, status[i], 0);
 }
 
-void Renderer::drawEntity(const Entity& entity) {
+void Renderer::drawShape(int row, int col, const Shape& shape, int color) {
     // Offset by 1 row (HUD is 0, Border is 1, Game starts at 2?)
     // Let's say HUD is row 0. Top border is row 1. Game rows 0..29 map to screen rows 2..31.
-    std::string glyph = entity.getGlyph();
-    int r = entity.getRow() + 2;
-    int c = entity.getCol() + 1;
-    
-    std::stringstream ss(glyph);
-    std::string line;
-    int maxWidth = 0;
-    std::vector<std::string> lines;
-    while (std::getline(ss, line)) {
-        if ((int)line.size() > maxWidth) maxWidth = (int)line.size();
-        lines.push_back(line);
-    }
+    int r = row - cameraRow_ + 2;
+    int c = col - cameraCol_ + 1;
 
     // Clear the draw area for this entity first (prevents artifacts from previous frame/overdraw).
     const int screenTop = 2;
     const int screenBottom = rows_ + 1;
     const int screenLeft = 1;
     const int screenRight = cols_;
+    if (r + shape.height <= screenTop || r > screenBottom) return; // 整个在视口外
+    if (c + shape.width <= screenLeft || c > screenRight) return;
 
-    int h = (int)lines.size();
-    if (h == 0) h = 1;
-    if (maxWidth <= 0) maxWidth = 1;
-
-    for (int dr = 0; dr < h; ++dr) {
+    for (int dr = 0; dr < shape.height; ++dr) {
         int rr = r + dr;
         if (rr < screenTop || rr > screenBottom) continue;
-        for (int dc = 0; dc < maxWidth; ++dc) {
+        for (int dc = 0; dc < shape.width; ++dc) {
             int cc = c + dc;
             if (cc < screenLeft || cc > screenRight) continue;
-            mvaddch(rr, cc, ' ');
+            put(rr, cc, ' ', 0);
         }
     }
 
-    if (entity.getColor() > 0) attron(COLOR_PAIR(entity.getColor()));
-
     // Draw glyph
-    for (int i = 0; i < (int)lines.size(); ++i) {
-        int rr = r + i;
+    for (const ShapeCell& cell : shape.cells) {
+        int rr = r + cell.dr;
+        int cc = c + cell.dc;
         if (rr < screenTop || rr > screenBottom) continue;
-        const std::string& ln = lines[i];
-        for (int j = 0; j < (int)ln.size(); ++j) {
-            int cc = c + j;
-            if (cc < screenLeft || cc > screenRight) continue;
-            mvaddch(rr, cc, ln[j]);
-        }
+        if (cc < screenLeft || cc > screenRight) continue;
+        put(rr, cc, cell.ch, color);
     }
-    
-    if (entity.getColor() > 0) attroff(COLOR_PAIR(entity.getColor()));
+}
+
+void Renderer::drawEffect(int row, int col, char ch, int color) {
+    const int r = row - cameraRow_;
+    const int c = col - cameraCol_;
+    if (r < 0 || r >= rows_ || c < 0 || c >= cols_) return;
+    Cell& cell = cells_[(r + 2) * screenCols_ + c + 1];
+    if (cell.ch != ' ') return;
+    cell.ch = ch;
+    cell.color = monochrome_ ? 0 : (std::uint8_t)color;
+}
+
+void Renderer::drawCell(int screenRow, int screenCol, char ch, int color) {
+    put(screenRow, screenCol, ch, color);
 }
 
 void Renderer::printAt(int row, int col, const std::string &text) {
-    mvaddnstr(row + 2, col + 1, text.c_str(), cols_ - col);
+    const int limit = cols_ - col;
+    const int n = (int)text.size() < limit ? (int)text.size() : limit;
+    for (int i = 0; i < n; ++i) put(row + 2, col + 1 + i, text[i], 0);
 }
 
-void Renderer::present() {
-    refresh();
+void Renderer::drawOverlay(const char* text) {
+    const int limit = screenCols_ - 2; // 不盖住两角
+    const int len = (int)std::strlen(text);
+    const int n = len < limit ? len : limit;
+    const int col = screenCols_ - 1 - n;
+    for (int i = 0; i < n; ++i) put(rows_ + 2, col + i, text[i], 0);
 }
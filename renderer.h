@@ -1,23 +1,85 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <ncurses.h>
-#include "entity.h"
+#include <vector>
+#include "field_of_view.h"
+#include "shapes.h"
 #include "world.h"
 
+enum class RenderBackend {
+    NCURSES, // 默认：ncurses 终端
+    ANSI,    // 直接输出 ANSI/VT 控制序列，每帧一次 write()
+    MEMORY   // 只画到内存，用于测试与基准（无需终端）
+};
+
+// 解析 --render 参数（ncurses / ansi / memory），无法识别时返回 false
+bool parseRenderBackend(const std::string& name, RenderBackend* out);
+
+// 一次 present() 的输出开销：送出的字节数与耗时（终端写满时的阻塞也算在内），
+// 以及终端暂时收不下、留到下一次 present() 再送的字节数。
+// 拿不到确切字节数的后端（ncurses）改报交出去的格数，并置 cells
+struct PresentCost {
+    std::size_t bytes = 0;
+    double ms = 0;
+    std::size_t backlog = 0;
+    bool cells = false; // bytes / backlog 的单位是格而不是字节
+};
+
+// 绘制接口：所有 draw* 只写入内存中的字符格，present() 由具体后端把这一帧送出去。
+// 屏幕布局：第 0 行 HUD，第 1 行与第 rows+2 行为边框，游戏区 (row, col) 对应屏幕 (row + 2, col + 1)。
+// 地图比游戏区大时，drawWorld / drawShape 按摄像机（视口左上角的地图坐标）平移；printAt 不受影响。
 class Renderer {
 public:
     Renderer(int rows, int cols);
-    ~Renderer();
+    virtual ~Renderer() = default;
+
+    void setCamera(int row, int col) { cameraRow_ = row; cameraCol_ = col; }
+    // 单色：之后画的格子一律不带颜色，省掉颜色切换的控制序列
+    void setMonochrome(bool on) { monochrome_ = on; }
 
     void clear();
     void drawBorders();
-    void drawWorld(const World& world);
-    void drawHud(const std::string &status);
-    void drawEntity(const Entity& entity);
+    void drawWorld(const World& world, const FieldOfView* fog = nullptr); // fog 非空时视野外的海面画成迷雾
+    void drawHud(const char* status);
+    void drawShape(int row, int col, const Shape& shape, int color);
+    // 特效层的一格（地图坐标）：只画在空白的海面上，舰船、岛屿、迷雾都在它上面
+    void drawEffect(int row, int col, char ch, int color);
     void printAt(int row, int col, const std::string &text);
-    void present();
+    void drawCell(int screenRow, int screenCol, char ch, int color); // 屏幕坐标的一格，不受摄像机影响（小地图等面板）
+    void drawOverlay(const char* text); // 调试浮层：右对齐画在底部边框上
+    virtual void present() = 0;
+
+    // 上一次 present() 的开销；内存后端始终为 0
+    const PresentCost& lastPresent() const { return lastPresent_; }
+
+    int screenRows() const { return screenRows_; }
+    int screenCols() const { return screenCols_; }
+
+protected:
+    struct Cell {
+        char ch = ' ';
+        std::uint8_t color = 0; // 颜色编号，见 archetypes.h
+        bool operator==(const Cell& o) const { return ch == o.ch && color == o.color; }
+        bool operator!=(const Cell& o) const { return !(*this == o); }
+    };
+
+    const Cell& cellAt(int screenRow, int screenCol) const { return cells_[screenRow * screenCols_ + screenCol]; }
 
-private:
     int rows_;
     int cols_;
+    int cameraRow_ = 0;
+    int cameraCol_ = 0;
+    int screenRows_;
+    int screenCols_;
+    PresentCost lastPresent_;
+
+private:
+    void put(int screenRow, int screenCol, char ch, int color);
+
+    std::vector<Cell> cells_;
+    bool monochrome_ = false;
 };
+
+// fd：ANSI 后端的输出（-1 为标准输出），其余后端忽略
+std::unique_ptr<Renderer> makeRenderer(RenderBackend backend, int rows, int cols, int fd = -1);
@@ -0,0 +1,35 @@
+#include "rng.h"
+
+void Rng::reseed(std::uint64_t seed) {
+    // splitmix64 打散种子，避免相邻种子得到相近的序列；状态不能为 0
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    state_ = z != 0 ? z : 1;
+}
+
+std::uint32_t Rng::next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return (std::uint32_t)((state_ * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+namespace {
+thread_local Rng* boundRng = nullptr;
+} // namespace
+
+Rng& gameRng() {
+    if (boundRng) return *boundRng;
+    static Rng fallback;
+    return fallback;
+}
+
+GameRngScope::GameRngScope(Rng& rng) : previous_(boundRng) {
+    boundRng = &rng;
+}
+
+GameRngScope::~GameRngScope() {
+    boundRng = previous_;
+}
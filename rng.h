@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+// 游戏逻辑用的随机数（刷怪、敌舰游走、道具、随机地图种子）。
+// 不用 std::rand：状态自己持有，同一种子的运行可以逐帧复现，状态也能计入状态哈希。
+// xorshift64*：一次乘法，周期 2^64 - 1。
+class Rng {
+public:
+    explicit Rng(std::uint64_t seed = 1) { reseed(seed); }
+
+    void reseed(std::uint64_t seed);
+    std::uint32_t next();
+    // [0, n) 内的整数，n > 0
+    int below(int n) { return (int)(next() % (std::uint32_t)n); }
+
+    std::uint64_t state() const { return state_; }
+
+private:
+    std::uint64_t state_ = 1;
+};
+
+// 当前线程的游戏随机数。每个 Game 持有自己的 Rng，构造与每帧运行期间用 GameRngScope
+// 绑定到本线程，服务器进程里各会话的随机数序列互不干扰；没有绑定时使用进程内的默认实例
+Rng& gameRng();
+
+class GameRngScope {
+public:
+    explicit GameRngScope(Rng& rng);
+    ~GameRngScope();
+    GameRngScope(const GameRngScope&) = delete;
+    GameRngScope& operator=(const GameRngScope&) = delete;
+
+private:
+    Rng* previous_;
+};
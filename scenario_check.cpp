@@ -0,0 +1,124 @@
+#include "scenario_check.h"
+#include "prefabs.h"
+#include "systems.h"
+#include "world.h"
+#include <cstdio>
+#include <string>
+
+namespace {
+
+constexpr int kRows = 40;
+constexpr int kCols = 80;
+
+// 一片没有岛屿的海面，玩家停在左下角，远离场景里的投射物
+struct Scene {
+    World world{kRows, kCols, IslandParams{1, 0}};
+    GameRegistry reg;
+    CollisionSystem collisions;
+    EntityId player;
+
+    Scene() { player = spawnPlayer(reg, kRows - 3, 1); }
+
+    void tick() {
+        projectileSystem(reg, world);
+        collisions.run(reg, player, world);
+        reg.sweep();
+    }
+};
+
+struct Result {
+    bool ok = true;
+    std::string detail;
+
+    void expect(bool condition, const std::string& what) {
+        if (condition || !ok) return;
+        ok = false;
+        detail = what;
+    }
+};
+
+// 巡洋舰的齐射：向下的炮弹与追踪导弹从同一格出发、同一方向
+Result sameSideVolley() {
+    Result result;
+    Scene s;
+    const EntityId shell = spawnProjectile(s.reg, 10, 40, 1, 0, ProjectileType::SHELL, Side::ENEMY);
+    const EntityId missile = spawnProjectile(s.reg, 10, 40, 1, 0, ProjectileType::MISSILE, Side::ENEMY);
+    for (int t = 1; t <= 3; ++t) {
+        s.tick();
+        result.expect(s.reg.alive(shell) && s.reg.alive(missile),
+                      "enemy shell and missile fired together destroyed each other at tick " + std::to_string(t));
+    }
+    return result;
+}
+
+// 玩家的炮弹与导弹同时开火，共用炮口
+Result playerVolley() {
+    Result result;
+    Scene s;
+    const EntityId shell = spawnProjectile(s.reg, 30, 40, -1, 0, ProjectileType::SHELL, Side::PLAYER);
+    const EntityId missile = spawnProjectile(s.reg, 30, 40, -1, 0, ProjectileType::MISSILE, Side::PLAYER);
+    for (int t = 1; t <= 3; ++t) {
+        s.tick();
+        result.expect(s.reg.alive(shell) && s.reg.alive(missile),
+                      "player shell and missile fired together destroyed each other at tick " + std::to_string(t));
+    }
+    return result;
+}
+
+// 玩家先发导弹、下一帧再发炮弹：每帧 2 格的炮弹在第 2 帧追上每帧 1 格的导弹，两者经过同一格
+Result missileThenShell() {
+    Result result;
+    Scene s;
+    const EntityId missile = spawnProjectile(s.reg, 30, 40, -1, 0, ProjectileType::MISSILE, Side::PLAYER);
+    s.tick();
+    const EntityId shell = spawnProjectile(s.reg, 30, 40, -1, 0, ProjectileType::SHELL, Side::PLAYER);
+    for (int t = 2; t <= 6; ++t) {
+        s.tick();
+        result.expect(s.reg.alive(shell) && s.reg.alive(missile),
+                      "player shell overtaking its own missile destroyed both at tick " + std::to_string(t));
+    }
+    // 炮弹确实越过了导弹，说明两者在途中交会过
+    if (result.ok) {
+        result.expect(s.reg.get<Position>(shell)->row < s.reg.get<Position>(missile)->row,
+                      "shell never overtook the missile");
+    }
+    return result;
+}
+
+// 敌对双方：玩家的炮弹迎面打下来袭的导弹
+Result hostileIntercept() {
+    Result result;
+    Scene s;
+    const EntityId missile = spawnProjectile(s.reg, 10, 40, 1, 0, ProjectileType::MISSILE, Side::ENEMY);
+    const EntityId shell = spawnProjectile(s.reg, 20, 40, -1, 0, ProjectileType::SHELL, Side::PLAYER);
+    for (int t = 0; t < 6 && (s.reg.alive(missile) || s.reg.alive(shell)); ++t) s.tick();
+    result.expect(!s.reg.alive(missile) && !s.reg.alive(shell), "player shell did not intercept the enemy missile");
+    return result;
+}
+
+} // namespace
+
+int checkScenarios() {
+    internPrefabShapes();
+    struct Entry {
+        const char* name;
+        Result (*run)();
+    };
+    const Entry kScenarios[] = {
+        {"same_side_volley", sameSideVolley},
+        {"player_volley", playerVolley},
+        {"missile_then_shell", missileThenShell},
+        {"hostile_intercept", hostileIntercept},
+    };
+    int failures = 0;
+    for (const Entry& e : kScenarios) {
+        const Result r = e.run();
+        if (r.ok) {
+            std::printf("%s: ok\n", e.name);
+        } else {
+            std::printf("%s: FAILED (%s)\n", e.name, r.detail.c_str());
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// 规则自检（--check-scenarios）：在空白海面上直接摆好几个实体，只跑投射物与碰撞系统若干帧，
+// 逐条检查具体的规则（如同一方的投射物不互相拦截）。金标准轨迹只能发现“变了”，这里说明“对不对”。
+// 每个场景打印一行结果；返回进程退出码，有任何场景失败时为 1
+int checkScenarios();
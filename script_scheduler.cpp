@@ -0,0 +1,177 @@
+#include "script_scheduler.h"
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+template <typename Waiter>
+bool higherThreshold(const Waiter& a, const Waiter& b) {
+    return a.threshold > b.threshold;
+}
+
+template <typename Waiter>
+bool lowerThreshold(const Waiter& a, const Waiter& b) {
+    return a.threshold < b.threshold;
+}
+
+} // namespace
+
+void Encounter::promise_type::unhandled_exception() noexcept {
+    std::terminate(); // 脚本里不应抛异常
+}
+
+Encounter::~Encounter() {
+    if (handle_) handle_.destroy(); // 没交给调度器就被丢弃的脚本
+}
+
+ScriptScheduler::~ScriptScheduler() {
+    clear();
+}
+
+ScriptId ScriptScheduler::start(Encounter script) {
+    std::uint32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = (std::uint32_t)slots_.size();
+        growingPush(slots_, Slot{});
+    }
+    Slot& slot = slots_[index];
+    slot.handle = script.handle_;
+    script.handle_ = nullptr;
+    slot.seq = nextSeq_++;
+    slot.counter = -1;
+    const ScriptId id{index, slot.generation};
+    slot.handle.promise().id = id;
+    ++live_;
+    resume(id);
+    return id;
+}
+
+bool ScriptScheduler::alive(ScriptId id) const {
+    return id.index < slots_.size() && slots_[id.index].handle && slots_[id.index].generation == id.generation;
+}
+
+void ScriptScheduler::cancel(ScriptId id) {
+    if (!alive(id)) return;
+    Slot& slot = slots_[id.index];
+    // 时间轮里的登记留着，到期时按代数作废；计数器堆里的等待立即摘掉，免得高阈值的残留一直占着
+    if (slot.counter >= 0) {
+        Counter& c = counters_[slot.counter];
+        std::vector<Waiter>& heap = slot.rising ? c.rising : c.falling;
+        for (std::size_t i = 0; i < heap.size(); ++i) {
+            if (heap[i].script != id) continue;
+            heap[i] = heap.back();
+            heap.pop_back();
+            if (slot.rising) std::make_heap(heap.begin(), heap.end(), higherThreshold<Waiter>);
+            else std::make_heap(heap.begin(), heap.end(), lowerThreshold<Waiter>);
+            break;
+        }
+    }
+    release(id.index);
+}
+
+void ScriptScheduler::clear() {
+    for (std::uint32_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].handle) release(i);
+    }
+    for (Counter& c : counters_) {
+        c.rising.clear();
+        c.falling.clear();
+    }
+    ready_.clear();
+}
+
+void ScriptScheduler::release(std::uint32_t index) {
+    Slot& slot = slots_[index];
+    slot.handle.destroy();
+    slot.handle = nullptr;
+    slot.counter = -1;
+    slot.generation++;
+    growingPush(free_, index);
+    --live_;
+}
+
+void ScriptScheduler::resume(ScriptId id) {
+    // 恢复期间脚本可能启动新脚本，slots_ 会扩容，句柄先取出来
+    const Encounter::Handle handle = slots_[id.index].handle;
+    slots_[id.index].counter = -1;
+    handle.resume();
+    if (handle.done()) release(id.index);
+}
+
+void ScriptScheduler::resumeInOrder(std::vector<ScriptId>& ids) {
+    std::sort(ids.begin(), ids.end(), [this](ScriptId a, ScriptId b) {
+        return slots_[a.index].seq < slots_[b.index].seq;
+    });
+    // 前面的脚本可能取消了后面的，逐个再确认一次
+    for (ScriptId id : ids) {
+        if (alive(id)) resume(id);
+    }
+}
+
+void ScriptScheduler::sleep(ScriptId id, std::uint32_t ticks) {
+    wheel_.schedule(wheel_.now() + ticks, TimerEvent{id, 0, TimerKind::SCRIPT});
+}
+
+void ScriptScheduler::advance() {
+    due_.clear();
+    wheel_.advance(due_);
+    if (due_.empty()) return;
+    resuming_.clear();
+    for (const TimerEvent& ev : due_) {
+        if (alive(ev.entity)) growingPush(resuming_, ev.entity);
+    }
+    resumeInOrder(resuming_);
+    resuming_.clear();
+}
+
+ScriptScheduler::CounterId ScriptScheduler::addCounter(int value) {
+    growingPush(counters_, Counter{});
+    counters_.back().value = value;
+    return (CounterId)counters_.size() - 1;
+}
+
+bool ScriptScheduler::Until::await_ready() const noexcept {
+    const int v = scheduler->value(counter);
+    return rising ? v >= threshold : v <= threshold;
+}
+
+void ScriptScheduler::until(ScriptId id, const Until& wait) {
+    Slot& slot = slots_[id.index];
+    slot.counter = wait.counter;
+    slot.rising = wait.rising;
+    Counter& c = counters_[wait.counter];
+    if (wait.rising) {
+        growingPush(c.rising, Waiter{wait.threshold, id});
+        std::push_heap(c.rising.begin(), c.rising.end(), higherThreshold<Waiter>);
+    } else {
+        growingPush(c.falling, Waiter{wait.threshold, id});
+        std::push_heap(c.falling.begin(), c.falling.end(), lowerThreshold<Waiter>);
+    }
+}
+
+void ScriptScheduler::set(CounterId counter, int value) {
+    Counter& c = counters_[counter];
+    c.value = value;
+    while (!c.rising.empty() && c.rising.front().threshold <= value) {
+        std::pop_heap(c.rising.begin(), c.rising.end(), higherThreshold<Waiter>);
+        growingPush(ready_, c.rising.back().script);
+        c.rising.pop_back();
+    }
+    while (!c.falling.empty() && c.falling.front().threshold >= value) {
+        std::pop_heap(c.falling.begin(), c.falling.end(), lowerThreshold<Waiter>);
+        growingPush(ready_, c.falling.back().script);
+        c.falling.pop_back();
+    }
+}
+
+void ScriptScheduler::settle() {
+    // 恢复的脚本又可能改动计数器、让别的脚本就绪，循环到没有为止
+    while (!ready_.empty()) {
+        resuming_.swap(ready_);
+        resumeInOrder(resuming_);
+        resuming_.clear();
+    }
+}
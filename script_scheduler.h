@@ -0,0 +1,129 @@
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <vector>
+#include "timer_wheel.h"
+
+// 脚本句柄：与实体一样是 槽位 + 代数，脚本结束或被取消后旧句柄自动失效
+using ScriptId = EntityId;
+
+// 遭遇脚本：一个 C++20 协程，用 co_await 等待帧数或计数器条件，例如
+//     for (;;) { co_await scripts.wait(50); spawnWave(); }
+//     co_await scripts.atLeast(coins, 100);
+// 由 ScriptScheduler::start 接管并立即运行到第一个 co_await；之后只在等待的条件满足时被恢复。
+class Encounter {
+public:
+    struct promise_type {
+        ScriptId id;
+
+        Encounter get_return_object() { return Encounter(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; } // 由调度器回收协程帧
+        void return_void() {}
+        void unhandled_exception() noexcept;
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Encounter(Encounter&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    Encounter(const Encounter&) = delete;
+    Encounter& operator=(const Encounter&) = delete;
+    ~Encounter();
+
+private:
+    friend class ScriptScheduler;
+    explicit Encounter(Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+};
+
+// 脚本调度器：挂起中的脚本不占任何每帧开销。
+// 等待帧数的脚本登记在自己的时间轮上（与 Game::timers_ 同步前进），到期才恢复；
+// 等待计数器的脚本按阈值放在该计数器的堆里，计数变化时只看堆顶，越过阈值的脚本进入就绪队列，
+// 在 settle() 时统一恢复（计数往往在清理实体之类的中途变化，那里不适合运行脚本）。
+// 同一时刻就绪的脚本按启动顺序恢复，结果与登记顺序无关，保证确定性。
+class ScriptScheduler {
+public:
+    using CounterId = int;
+
+    ScriptScheduler() = default;
+    ScriptScheduler(const ScriptScheduler&) = delete;
+    ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+    ~ScriptScheduler();
+
+    // 接管并立即运行到第一个 co_await；脚本可以在运行中启动别的脚本
+    ScriptId start(Encounter script);
+    // 取消一个挂起中的脚本（不能取消正在运行的脚本自己）；句柄已失效时什么也不做
+    void cancel(ScriptId id);
+    // 取消全部脚本
+    void clear();
+    bool alive(ScriptId id) const;
+    std::size_t count() const { return live_; }
+
+    // 前进一帧，恢复等待到本帧的脚本；每个逻辑帧调用一次
+    void advance();
+    // 恢复计数器条件已满足的脚本（直到没有新的就绪脚本）
+    void settle();
+    std::uint32_t now() const { return wheel_.now(); }
+
+    // 计数器：由游戏维护的整数（金币、各舰种存活数……），脚本等待它越过阈值
+    CounterId addCounter(int value = 0);
+    void set(CounterId counter, int value);
+    void add(CounterId counter, int delta) { set(counter, counters_[counter].value + delta); }
+    int value(CounterId counter) const { return counters_[counter].value; }
+
+    struct Sleep {
+        ScriptScheduler* scheduler;
+        std::uint32_t ticks;
+        bool await_ready() const noexcept { return ticks == 0; }
+        void await_suspend(Encounter::Handle h) const { scheduler->sleep(h.promise().id, ticks); }
+        void await_resume() const noexcept {}
+    };
+    struct Until {
+        ScriptScheduler* scheduler;
+        CounterId counter;
+        int threshold;
+        bool rising; // true：等到 value >= threshold；false：等到 value <= threshold
+        bool await_ready() const noexcept;
+        void await_suspend(Encounter::Handle h) const { scheduler->until(h.promise().id, *this); }
+        void await_resume() const noexcept {}
+    };
+
+    // co_await 的对象：等待 ticks 帧 / 等到计数器 >= n / <= n
+    Sleep wait(std::uint32_t ticks) { return Sleep{this, ticks}; }
+    Until atLeast(CounterId counter, int n) { return Until{this, counter, n, true}; }
+    Until atMost(CounterId counter, int n) { return Until{this, counter, n, false}; }
+
+private:
+    struct Slot {
+        Encounter::Handle handle;
+        std::uint64_t seq = 0;     // 启动顺序，决定同时就绪的脚本谁先运行
+        std::uint32_t generation = 0;
+        CounterId counter = -1;    // 正在等待的计数器（-1：没有）
+        bool rising = false;
+    };
+    struct Waiter {
+        int threshold;
+        ScriptId script;
+    };
+    struct Counter {
+        int value = 0;
+        std::vector<Waiter> rising;  // 小顶堆：阈值最低的最先满足
+        std::vector<Waiter> falling; // 大顶堆
+    };
+
+    void sleep(ScriptId id, std::uint32_t ticks);
+    void until(ScriptId id, const Until& wait);
+    void resume(ScriptId id);
+    void release(std::uint32_t index);
+    void resumeInOrder(std::vector<ScriptId>& ids);
+
+    TimerWheel wheel_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_;
+    std::vector<Counter> counters_;
+    std::vector<TimerEvent> due_;
+    std::vector<ScriptId> ready_;    // 计数器条件已满足、等待 settle() 的脚本
+    std::vector<ScriptId> resuming_;
+    std::uint64_t nextSeq_ = 0;
+    std::size_t live_ = 0;
+};
@@ -0,0 +1,44 @@
+#include "shapes.h"
+#include <deque>
+#include <sstream>
+
+namespace {
+
+// deque：新增外形时已有外形的引用保持有效
+std::deque<Shape>& library() {
+    static std::deque<Shape> shapes;
+    return shapes;
+}
+
+} // namespace
+
+ShapeId internShape(const std::string& glyph) {
+    auto& shapes = library();
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        if (shapes[i].glyph == glyph) return (ShapeId)i;
+    }
+
+    Shape shape;
+    shape.glyph = glyph;
+    std::stringstream ss(glyph);
+    std::string line;
+    int dr = 0;
+    int maxWidth = 0;
+    while (std::getline(ss, line)) {
+        if ((int)line.size() > maxWidth) maxWidth = (int)line.size();
+        for (int dc = 0; dc < (int)line.size(); ++dc) {
+            if (line[dc] == ' ') continue;
+            shape.cells.push_back({(std::int8_t)dr, (std::int8_t)dc, line[dc]});
+        }
+        ++dr;
+    }
+    shape.height = dr > 0 ? dr : 1;
+    shape.width = maxWidth > 0 ? maxWidth : 1;
+
+    shapes.push_back(std::move(shape));
+    return (ShapeId)(shapes.size() - 1);
+}
+
+const Shape& shapeOf(ShapeId id) {
+    return library()[id];
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 外形（glyph）预先解析成占格列表，运行时不再逐帧解析字符串
+using ShapeId = std::uint16_t;
+
+struct ShapeCell {
+    std::int8_t dr;
+    std::int8_t dc;
+    char ch;
+};
+
+struct Shape {
+    std::string glyph;
+    std::vector<ShapeCell> cells; // 非空格字符的占格
+    int height = 1;               // 包围盒（至少 1×1），绘制前用于清空区域
+    int width = 1;
+};
+
+// 相同 glyph 只解析一次，返回同一个编号。外形库不加锁：只在启动阶段（单线程）登记，
+// 之后多个线程可以同时读
+ShapeId internShape(const std::string& glyph);
+const Shape& shapeOf(ShapeId id);
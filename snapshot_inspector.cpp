@@ -0,0 +1,50 @@
+#include "snapshot_inspector.h"
+#include "snapshot_ring.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onSignal(int) {
+    interrupted = 1;
+}
+
+void printSnapshot(const Snapshot& s) {
+    int counts[4] = {};
+    for (std::uint32_t i = 0; i < s.count; ++i) counts[(int)s.entities[i].kind]++;
+    std::printf("#%llu tick %u  %s %d  hp %d/%d  coins %d  ammo %d/%d/%d  ships %d  shots %d  pickups %d",
+                (unsigned long long)s.serial, s.tick, s.survival ? "survival" : "level", s.level, s.hp, s.maxHp,
+                s.coins, s.shells, s.torpedoes, s.missiles, counts[(int)SnapshotKind::ENEMY],
+                counts[(int)SnapshotKind::PROJECTILE], counts[(int)SnapshotKind::PICKUP]);
+    if (s.dropped > 0) std::printf("  (+%u not recorded)", s.dropped);
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int runSnapshotInspector(const std::string& name) {
+    SnapshotReader reader;
+    if (!reader.open(name)) return 1;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    auto snapshot = std::make_unique<Snapshot>(); // 一帧约 32 KB，不放在栈上
+    std::uint64_t shown = 0;
+    while (!interrupted) {
+        const bool alive = reader.writerAlive();
+        const std::uint64_t latest = reader.published();
+        if (latest != shown && reader.read(latest, *snapshot)) {
+            printSnapshot(*snapshot);
+            shown = latest;
+        }
+        if (!alive) break; // 写端已退出：上面已经打印了它的最后一帧
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+}
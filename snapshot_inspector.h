@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// 快照环（--snapshots）的命令行读端：每 100ms 取一次最新快照，打印帧号、HUD 数值与各类实体数。
+// 写端退出或 Ctrl-C 时结束。返回进程退出码
+int runSnapshotInspector(const std::string& name);
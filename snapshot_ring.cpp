@@ -0,0 +1,129 @@
+#include "snapshot_ring.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+std::string shmName(const std::string& name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+} // namespace
+
+SnapshotWriter::~SnapshotWriter() {
+    if (!region_) return;
+    region_->writerAlive.store(0, std::memory_order_release);
+    munmap(region_, sizeof(SnapshotRegion));
+    shm_unlink(name_.c_str()); // 已经映射的读端照常可读，之后新开的读端找不到它
+}
+
+bool SnapshotWriter::open(const std::string& name) {
+    name_ = shmName(name);
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: shm_open: %s\n", name_.c_str(), std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SnapshotRegion)) < 0) {
+        std::fprintf(stderr, "%s: ftruncate: %s\n", name_.c_str(), std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(SnapshotRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::fprintf(stderr, "%s: mmap: %s\n", name_.c_str(), std::strerror(errno));
+        return false;
+    }
+    region_ = static_cast<SnapshotRegion*>(p);
+    // 同名的旧内存（上次没正常退出）直接清掉重来；先把 magic 置 0，读端在初始化完成前不认它
+    region_->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    region_->published.store(0, std::memory_order_relaxed);
+    for (SnapshotSlot& slot : region_->slot) {
+        slot.seq.store(0, std::memory_order_relaxed);
+        slot.data.serial = 0;
+    }
+    region_->version = kSnapshotVersion;
+    region_->slots = kSnapshotSlots;
+    region_->capacity = kSnapshotCapacity;
+    region_->writerAlive.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    region_->magic = kSnapshotMagic;
+    return true;
+}
+
+Snapshot& SnapshotWriter::begin() {
+    const std::uint64_t serial = region_->published.load(std::memory_order_relaxed) + 1;
+    writing_ = &region_->slot[(serial - 1) % kSnapshotSlots];
+    writing_->seq.store(writing_->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // 奇数序号先于数据可见
+    writing_->data.serial = serial;
+    return writing_->data;
+}
+
+void SnapshotWriter::commit() {
+    writing_->seq.store(writing_->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    region_->published.store(writing_->data.serial, std::memory_order_release);
+    writing_ = nullptr;
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (region_) munmap(const_cast<SnapshotRegion*>(region_), sizeof(SnapshotRegion));
+}
+
+bool SnapshotReader::open(const std::string& name) {
+    const std::string path = shmName(name);
+    const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: shm_open: %s\n", path.c_str(), std::strerror(errno));
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(SnapshotRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::fprintf(stderr, "%s: mmap: %s\n", path.c_str(), std::strerror(errno));
+        return false;
+    }
+    region_ = static_cast<const SnapshotRegion*>(p);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (region_->magic != kSnapshotMagic || region_->version != kSnapshotVersion) {
+        std::fprintf(stderr, "%s: not a snapshot ring (or a different version)\n", path.c_str());
+        munmap(p, sizeof(SnapshotRegion));
+        region_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t SnapshotReader::published() const {
+    return region_->published.load(std::memory_order_acquire);
+}
+
+bool SnapshotReader::writerAlive() const {
+    return region_->writerAlive.load(std::memory_order_acquire) != 0;
+}
+
+bool SnapshotReader::read(std::uint64_t serial, Snapshot& out) const {
+    if (serial == 0 || serial > published()) return false;
+    const SnapshotSlot& slot = region_->slot[(serial - 1) % kSnapshotSlots];
+    constexpr std::size_t kHeader = offsetof(Snapshot, entities);
+    // 写端在写的途中崩溃会让序号一直停在奇数，重试有上限
+    for (int attempt = 0; attempt < 100000; ++attempt) {
+        const std::uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) continue; // 正在写，写一帧只要几微秒
+        std::memcpy(&out, &slot.data, kHeader);
+        const std::uint32_t count = out.count < (std::uint32_t)kSnapshotCapacity ? out.count : kSnapshotCapacity;
+        std::memcpy(out.entities, slot.data.entities, count * sizeof(SnapshotEntity));
+        std::atomic_thread_fence(std::memory_order_acquire); // 拷贝先于再读序号
+        if (slot.seq.load(std::memory_order_relaxed) != before) continue;
+        out.count = count;
+        return out.serial == serial; // 槽位已经写了更新的快照：要的这一帧被覆盖了
+    }
+    return false;
+}
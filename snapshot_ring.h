@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 快照环：游戏每个逻辑帧把实体位置 / 种类 / 生命、HUD 数值与帧号写进 POSIX 共享内存
+// （shm_open + mmap）里的一个环，外部工具（可视化、热力图采集、时间回溯查看器）映射同一块内存读取，
+// 不需要挂调试器。每个槽位一个顺序锁（seqlock）：写端写之前把序号改成奇数、写完改成下一个偶数；
+// 读端拷贝前后各读一次序号，不一致（或为奇数）就重读。写端从不等待读端，读端也不加锁。
+// 布局只由下面的定长结构组成，换了布局就改 kSnapshotVersion。
+
+constexpr std::uint32_t kSnapshotMagic = 0x534E4150; // "SNAP"
+constexpr std::uint32_t kSnapshotVersion = 1;
+constexpr int kSnapshotSlots = 64;         // 保留最近 64 帧
+constexpr int kSnapshotCapacity = 4096;    // 每帧最多记录的实体数，多出的只计数
+
+enum class SnapshotKind : std::uint8_t {
+    PLAYER,
+    ENEMY,
+    PROJECTILE,
+    PICKUP
+};
+
+struct SnapshotEntity {
+    std::int16_t row;
+    std::int16_t col;
+    std::int16_t hp;   // 投射物与道具为 0
+    SnapshotKind kind;
+    std::uint8_t type; // 敌舰：EnemyType；投射物：ProjectileType；道具：PickupType
+};
+
+struct Snapshot {
+    std::uint64_t serial; // 第几个快照（从 1 开始），读端据此判断槽位是否已被覆盖
+    std::uint32_t tick;   // 游戏时间轮的帧号
+    std::int32_t level;
+    std::uint8_t survival;
+    std::uint8_t state;   // GameState
+    std::int16_t worldRows;
+    std::int16_t worldCols;
+    std::int32_t hp;
+    std::int32_t maxHp;
+    std::int32_t coins;
+    std::int32_t shells;
+    std::int32_t torpedoes;
+    std::int32_t missiles;
+    std::uint32_t count;   // entities 中有效的条数
+    std::uint32_t dropped; // 超出容量没有记录的实体数
+    SnapshotEntity entities[kSnapshotCapacity];
+};
+
+struct SnapshotSlot {
+    std::atomic<std::uint32_t> seq; // 奇数：正在写
+    Snapshot data;
+};
+
+struct SnapshotRegion {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t slots;
+    std::uint32_t capacity;
+    std::atomic<std::uint64_t> published; // 已发布的快照数；第 n 个在 slot[(n - 1) % slots]
+    std::atomic<std::uint32_t> writerAlive;
+    SnapshotSlot slot[kSnapshotSlots];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "snapshot ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "snapshot ring needs lock-free 32-bit atomics");
+
+// 写端：游戏进程。名字按 shm_open 的规则（不以 / 开头时自动补上）；析构时删除共享内存
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // 创建（或接管同名的）共享内存；失败时返回 false 并把原因写到 stderr
+    bool open(const std::string& name);
+    bool isOpen() const { return region_ != nullptr; }
+
+    // 取下一个槽位并标记为正在写，调用方直接填写返回的快照（不再拷贝一次），然后 commit()
+    Snapshot& begin();
+    void commit();
+
+private:
+    SnapshotRegion* region_ = nullptr;
+    SnapshotSlot* writing_ = nullptr;
+    std::string name_;
+};
+
+// 读端：外部工具。只读映射，不会阻塞写端
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& name);
+    // 已发布的快照数（最新快照的 serial）
+    std::uint64_t published() const;
+    bool writerAlive() const;
+    // 拷贝第 serial 个快照（只拷贝有效的实体）；还没发布或已被覆盖时返回 false
+    bool read(std::uint64_t serial, Snapshot& out) const;
+
+private:
+    const SnapshotRegion* region_ = nullptr;
+};
@@ -0,0 +1,122 @@
+#include "state_hash.h"
+
+std::uint64_t hashCombine(std::uint64_t h, std::uint64_t v) {
+    h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+namespace {
+
+// 一个实体的摘要：句柄 + 表 + 所有会影响模拟的组件（颜色只影响绘制，不计入）
+template <typename T>
+std::uint64_t digestRow(const T& t, std::size_t r) {
+    const EntityId id = t.id(r);
+    std::uint64_t h = hashCombine(0x51ED2701A5C3E4B7ull, ((std::uint64_t)id.generation << 32) | id.index);
+    if constexpr (T::template has<PlayerState>()) h = hashCombine(h, 1);
+    if constexpr (T::template has<EnemyInfo>()) h = hashCombine(h, 2);
+    if constexpr (T::template has<ProjectileInfo>()) h = hashCombine(h, 3);
+    if constexpr (T::template has<PickupInfo>()) h = hashCombine(h, 4);
+
+    auto add = [&h](std::int64_t v) { h = hashCombine(h, (std::uint64_t)v); };
+    const Position& p = t.template column<Position>()[r];
+    add(p.row);
+    add(p.col);
+    add(t.template column<Footprint>()[r].shape);
+    if constexpr (T::template has<Health>()) {
+        const Health& hp = t.template column<Health>()[r];
+        add(hp.hp);
+        add(hp.maxHp);
+    }
+    if constexpr (T::template has<Ammo>()) {
+        const Ammo& a = t.template column<Ammo>()[r];
+        add(a.shells);
+        add(a.torpedoes);
+        add(a.missiles);
+    }
+    if constexpr (T::template has<AiTimers>()) {
+        const AiTimers& tm = t.template column<AiTimers>()[r];
+        add(tm.nextMove);
+        add(tm.nextFire);
+        add(tm.moveInterval);
+        add(tm.fireInterval);
+        add(tm.moveSteps);
+    }
+    if constexpr (T::template has<Velocity>()) {
+        const Velocity& v = t.template column<Velocity>()[r];
+        add(v.dRow);
+        add(v.dCol);
+    }
+    if constexpr (T::template has<EnemyInfo>()) {
+        const EnemyInfo& e = t.template column<EnemyInfo>()[r];
+        add(e.type);
+        add(e.dir);
+    }
+    if constexpr (T::template has<ProjectileInfo>()) {
+        const ProjectileInfo& pi = t.template column<ProjectileInfo>()[r];
+        add((int)pi.type);
+        add((int)pi.side);
+        add(pi.lifeTime);
+        add(pi.tracking);
+        add(pi.targetRow);
+        add(pi.targetCol);
+        add(pi.fresh);
+        add(pi.prevRow);
+        add(pi.prevCol);
+        add(pi.progress);
+        add(pi.steps);
+        add(pi.blocked);
+    }
+    if constexpr (T::template has<PickupInfo>()) add((int)t.template column<PickupInfo>()[r].type);
+    if constexpr (T::template has<PlayerState>()) {
+        const PlayerState& ps = t.template column<PlayerState>()[r];
+        add(ps.coins);
+        add(ps.lastDirRow);
+        add(ps.lastDirCol);
+    }
+    return h;
+}
+
+} // namespace
+
+std::uint64_t& StateHash::slot(EntityId id) {
+    if (id.index >= digest_.size()) digest_.resize(id.index + 1, 0);
+    return digest_[id.index];
+}
+
+template <typename T>
+void StateHash::refreshRow(const T& table, std::size_t row) {
+    if (table.isDead(row)) return;
+    std::uint64_t& d = slot(table.id(row));
+    const std::uint64_t next = digestRow(table, row);
+    total_ ^= d ^ next;
+    d = next;
+}
+
+template <typename T>
+void StateHash::refreshRows(const T& table, std::size_t from) {
+    for (std::size_t r = from; r < table.size(); ++r) refreshRow(table, r);
+}
+
+template void StateHash::refreshRow(const PlayerTable&, std::size_t);
+template void StateHash::refreshRow(const EnemyTable&, std::size_t);
+template void StateHash::refreshRow(const ProjectileTable&, std::size_t);
+template void StateHash::refreshRow(const PickupTable&, std::size_t);
+template void StateHash::refreshRows(const PlayerTable&, std::size_t);
+template void StateHash::refreshRows(const EnemyTable&, std::size_t);
+template void StateHash::refreshRows(const ProjectileTable&, std::size_t);
+template void StateHash::refreshRows(const PickupTable&, std::size_t);
+
+void StateHash::rebuild(const GameRegistry& reg) {
+    digest_.assign(digest_.size(), 0);
+    total_ = 0;
+    refreshRows(reg.table<PlayerTable>(), 0);
+    refreshRows(reg.table<EnemyTable>(), 0);
+    refreshRows(reg.table<ProjectileTable>(), 0);
+    refreshRows(reg.table<PickupTable>(), 0);
+}
+
+void StateHash::remove(EntityId id) {
+    std::uint64_t& d = slot(id);
+    total_ ^= d;
+    d = 0;
+}
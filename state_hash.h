@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "components.h"
+
+// 把 v 混入 h（每步一次乘法 + 移位），用于拼接各个字段
+std::uint64_t hashCombine(std::uint64_t h, std::uint64_t v);
+
+// 模拟状态中实体部分的 64 位哈希，增量维护：
+// 每个实体一个摘要（按句柄槽位存放），总值是所有存活实体摘要的异或。
+// 实体的组件变化后只重算它自己的摘要并异或进出，删除时把摘要异或掉，不必每帧重扫全部实体。
+// 地形哈希由 World 自己维护；随机数状态、帧号等标量由 Game 在取值时并入（见 Game::stateHash）。
+class StateHash {
+public:
+    // 全部重算：换关、热重载地图等整体变化之后调用
+    void rebuild(const GameRegistry& reg);
+
+    // 重算第 row 行实体的摘要；已标记死亡的行跳过，等 remove 时整体去掉
+    template <typename T>
+    void refreshRow(const T& table, std::size_t row);
+    // 重算 [from, size) 行
+    template <typename T>
+    void refreshRows(const T& table, std::size_t from);
+
+    // 实体被删除（Registry::sweep 的回调）
+    void remove(EntityId id);
+
+    std::uint64_t entities() const { return total_; }
+
+private:
+    std::uint64_t& slot(EntityId id);
+
+    std::vector<std::uint64_t> digest_; // 按 EntityId::index
+    std::uint64_t total_ = 0;
+};
@@ -0,0 +1,818 @@
+#include "systems.h"
+#include <algorithm>
+#include <cstdlib>
+#include "prefabs.h"
+#include "rng.h"
+
+bool canPlaceShape(const World& world, int row, int col, const Shape& shape) {
+    // 包围盒在图内且金字塔上查不到障碍：不必逐格检查
+    if (world.inBounds(row, col) && world.inBounds(row + shape.height - 1, col + shape.width - 1) &&
+        !world.mayBeBlocked(row, col, shape.height, shape.width)) {
+        return true;
+    }
+    for (const ShapeCell& cell : shape.cells) {
+        if (world.isBlocked(row + cell.dr, col + cell.dc)) return false;
+    }
+    return true;
+}
+
+bool findFreePlacement(const World& world, int& row, int& col, const Shape& shape, int maxRadius) {
+    if (canPlaceShape(world, row, col, shape)) return true;
+    // 按切比雪夫距离由近及远逐圈查找
+    for (int radius = 1; radius <= maxRadius; ++radius) {
+        for (int dr = -radius; dr <= radius; ++dr) {
+            const int step = (dr == -radius || dr == radius) ? 1 : 2 * radius;
+            for (int dc = -radius; dc <= radius; dc += step) {
+                if (canPlaceShape(world, row + dr, col + dc, shape)) {
+                    row += dr;
+                    col += dc;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void erosionSystem(const GameRegistry& reg, World& world, const std::vector<EntityId>& impacts) {
+    const ArchetypeTable& arch = archetypes();
+    for (EntityId id : impacts) {
+        const ProjectileInfo& info = *reg.get<ProjectileInfo>(id);
+        const std::uint8_t erode = arch.projectileErode[(int)info.type];
+        if (erode == Erode::NONE) continue;
+        // 投射物停在障碍前一格，沿速度方向再走一格就是撞上的那一格；出界的不算
+        const Position& pos = *reg.get<Position>(id);
+        const Velocity& vel = *reg.get<Velocity>(id);
+        const int row = pos.row + vel.dRow;
+        const int col = pos.col + vel.dCol;
+        if (!world.inBounds(row, col)) continue;
+        if (erode == Erode::CELL) {
+            world.setBlocked(row, col, false);
+            continue;
+        }
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) world.setBlocked(row + dr, col + dc, false);
+        }
+    }
+}
+
+void terrainChangedSystem(GameRegistry& reg, EntityId player, const World& world, const std::vector<CellChange>& changes) {
+    bool anyBlocked = false;
+    for (const CellChange& change : changes) anyBlocked |= change.blocked;
+    if (!anyBlocked) return; // 只有障碍被移除时，没有实体会受影响
+
+    // 投射物与道具：落在新障碍里的直接移除
+    reg.eachWithId<Position, ProjectileInfo>([&](EntityId id, const Position& p, const ProjectileInfo&) {
+        if (world.isBlocked(p.row, p.col)) reg.kill(id);
+    });
+    reg.eachWithId<Position, PickupInfo>([&](EntityId id, const Position& p, const PickupInfo&) {
+        if (world.isBlocked(p.row, p.col)) reg.kill(id);
+    });
+
+    // 舰船：挪到最近的空位；敌舰找不到空位就移除（不计分），玩家留在原地
+    const ArchetypeTable& arch = archetypes();
+    reg.eachWithId<Position, Footprint, EnemyInfo>([&](EntityId id, Position& p, const Footprint& fp, const EnemyInfo& info) {
+        if (arch.phasing[info.type]) return;
+        if (!findFreePlacement(world, p.row, p.col, shapeOf(fp.shape), kTerrainNudgeRadius)) reg.kill(id);
+    });
+    Position& playerPos = *reg.get<Position>(player);
+    findFreePlacement(world, playerPos.row, playerPos.col, shapeOf(reg.get<Footprint>(player)->shape), kTerrainNudgeRadius);
+}
+
+void playerControlSystem(GameRegistry& reg, EntityId player, const InputState& input, const World& world) {
+    Position& pos = *reg.get<Position>(player);
+    Footprint& fp = *reg.get<Footprint>(player);
+    Ammo& ammo = *reg.get<Ammo>(player);
+    PlayerState& state = *reg.get<PlayerState>(player);
+
+    // 移动
+    int nextRow = pos.row + input.dRow;
+    int nextCol = pos.col + input.dCol;
+
+    // 记录方向
+    if (input.dRow != 0 || input.dCol != 0) {
+        state.lastDirRow = input.dRow;
+        state.lastDirCol = input.dCol;
+
+        // 更新外形
+        fp.shape = playerShape(input.dRow != 0);
+    }
+
+    const Shape& shape = shapeOf(fp.shape);
+
+    // 边界/障碍检查：按实际外形占用的格子判断（避免船体出界导致“少一行”）
+    if (input.dRow != 0 || input.dCol != 0) {
+        if (canPlaceShape(world, nextRow, nextCol, shape)) {
+            pos.row = nextRow;
+            pos.col = nextCol;
+        }
+    }
+
+    // 发射方向为移动方向，如果静止则用最后方向，再否则默认向上
+    int dr = (input.dRow != 0 || input.dCol != 0) ? input.dRow : state.lastDirRow;
+    int dc = (input.dRow != 0 || input.dCol != 0) ? input.dCol : state.lastDirCol;
+    if (dr == 0 && dc == 0) {
+        dr = -1;
+        dc = 0;
+    }
+
+    // 从船体在该方向的“最前沿占格”外侧一格生成，避免出生在自身占格里造成自伤
+    auto muzzle = [&](int& muzzleRow, int& muzzleCol) {
+        muzzleRow = pos.row;
+        muzzleCol = pos.col;
+        int bestScore = -1e9;
+        for (const ShapeCell& cell : shape.cells) {
+            const int score = cell.dr * dr + cell.dc * dc;
+            if (score > bestScore) {
+                bestScore = score;
+                muzzleRow = pos.row + cell.dr;
+                muzzleCol = pos.col + cell.dc;
+            }
+        }
+    };
+
+    // 攻击
+    if (input.fireShell && ammo.shells > 0) {
+        ammo.shells--;
+        int muzzleRow = 0;
+        int muzzleCol = 0;
+        muzzle(muzzleRow, muzzleCol);
+        spawnProjectile(reg, muzzleRow + dr, muzzleCol + dc, dr, dc, ProjectileType::SHELL, Side::PLAYER);
+    }
+
+    auto fireSideParallel = [&](bool fireLeftOfForward) {
+        if (ammo.shells < 3) return;
+        ammo.shells -= 3;
+
+        // 相对 forward 的左/右：
+        // left  = (-forwardCol, forwardRow)
+        // right = ( forwardCol,-forwardRow)
+        const int fireDirRow = fireLeftOfForward ? (-dc) : (dc);
+        const int fireDirCol = fireLeftOfForward ? ( dr) : (-dr);
+
+        // 从当前外形的前三个占格作为炮口，并向侧边外移一格生成
+        int fired = 0;
+        for (const ShapeCell& cell : shape.cells) {
+            if (fired++ == 3) break;
+            spawnProjectile(reg,
+                            pos.row + cell.dr + fireDirRow,
+                            pos.col + cell.dc + fireDirCol,
+                            fireDirRow,
+                            fireDirCol,
+                            ProjectileType::SHELL,
+                            Side::PLAYER);
+        }
+    };
+
+    if (input.fireSpreadLeft) {
+        fireSideParallel(true);
+    }
+    if (input.fireSpreadRight) {
+        fireSideParallel(false);
+    }
+
+    if (input.fireMissile && ammo.missiles > 0) {
+        ammo.missiles--;
+        int muzzleRow = 0;
+        int muzzleCol = 0;
+        muzzle(muzzleRow, muzzleCol);
+        // 玩家导弹不追踪，沿发射方向直飞
+        spawnProjectile(reg, muzzleRow + dr, muzzleCol + dc, dr, dc, ProjectileType::MISSILE, Side::PLAYER);
+    }
+}
+
+namespace {
+
+template <MovePattern Move>
+void moveEnemy(Position& pos, const EnemyInfo& info, bool& leftArena, int playerRow, int playerCol, const World& world) {
+    const int maxRows = world.rows();
+    const int maxCols = world.cols();
+
+    if constexpr (Move == MovePattern::FLY) {
+        // Fly horizontally
+        int nextCol = pos.col + info.dir;
+        // Only disappear when attempting to leave bounds (allow edge positions).
+        if (nextCol < 0 || nextCol > maxCols - 2) {
+            leftArena = true;
+            return;
+        }
+        pos.col = nextCol;
+    } else if constexpr (Move == MovePattern::STRAFE) {
+        // Only move horizontally
+        int dCol = gameRng().below(3) - 1;
+        int nextCol = pos.col + dCol;
+        if (nextCol >= 0 && nextCol < maxCols) pos.col = nextCol;
+    } else {
+        // Move 4 directions randomly or towards player
+        int dRow = gameRng().below(3) - 1;
+        int dCol = gameRng().below(3) - 1;
+
+        // Simple AI: 50% chance to move towards player
+        if (gameRng().below(2) == 0) {
+            if (pos.row < playerRow) dRow = 1;
+            else if (pos.row > playerRow) dRow = -1;
+
+            if (pos.col < playerCol) dCol = 1;
+            else if (pos.col > playerCol) dCol = -1;
+        }
+
+        int nextRow = pos.row + dRow;
+        int nextCol = pos.col + dCol;
+        if (nextRow >= 0 && nextRow < maxRows && nextCol >= 0 && nextCol < maxCols) {
+            pos.row = nextRow;
+            pos.col = nextCol;
+        }
+    }
+}
+
+void fireEnemy(GameRegistry& reg, std::uint8_t pattern, const Position& pos, Ammo& ammo, int playerRow, int playerCol) {
+    const int row = pos.row;
+    const int col = pos.col;
+
+    // Calculate direction to player
+    int dr = 0, dc = 0;
+    if (row < playerRow) dr = 1; else if (row > playerRow) dr = -1;
+    if (col < playerCol) dc = 1; else if (col > playerCol) dc = -1;
+
+    if (pattern & FirePattern::AIMED) {
+        if (ammo.shells > 0) {
+            spawnProjectile(reg, row + dr, col + dc, dr, dc, ProjectileType::SHELL, Side::ENEMY);
+            ammo.shells--;
+        }
+    }
+    if (pattern & FirePattern::SIDE_TORPEDOES) {
+        if (ammo.torpedoes > 0) {
+            // Torpedo left/right
+            spawnProjectile(reg, row, col - 1, 0, -1, ProjectileType::TORPEDO, Side::ENEMY);
+            spawnProjectile(reg, row, col + 1, 0, 1, ProjectileType::TORPEDO, Side::ENEMY);
+            ammo.torpedoes--;
+        }
+    }
+    if (pattern & FirePattern::CROSS) {
+        if (ammo.shells >= 4) {
+            // Shells 4 directions
+            spawnProjectile(reg, row - 1, col, -1, 0, ProjectileType::SHELL, Side::ENEMY);
+            spawnProjectile(reg, row + 1, col, 1, 0, ProjectileType::SHELL, Side::ENEMY);
+            spawnProjectile(reg, row, col - 1, 0, -1, ProjectileType::SHELL, Side::ENEMY);
+            spawnProjectile(reg, row, col + 1, 0, 1, ProjectileType::SHELL, Side::ENEMY);
+            ammo.shells -= 4;
+        }
+    }
+    if (pattern & FirePattern::TRACKING_MISSILE) {
+        if (ammo.missiles > 0) {
+            // Missile
+            const EntityId m = spawnProjectile(reg, row + 1, col, 1, 0, ProjectileType::MISSILE, Side::ENEMY);
+            ProjectileInfo& info = *reg.get<ProjectileInfo>(m);
+            info.tracking = true;
+            info.targetRow = playerRow;
+            info.targetCol = playerCol;
+            ammo.missiles--;
+        }
+    }
+    if (pattern & FirePattern::DROP) {
+        // Drop torpedo or 3 bullets
+        if (gameRng().below(2) == 0) {
+            if (ammo.torpedoes > 0) {
+                spawnProjectile(reg, row + 1, col, 1, 0, ProjectileType::TORPEDO, Side::ENEMY);
+                ammo.torpedoes--;
+            }
+        } else {
+            if (ammo.shells >= 3) {
+                spawnProjectile(reg, row + 1, col, 1, 0, ProjectileType::SHELL, Side::ENEMY);
+                spawnProjectile(reg, row + 1, col - 1, 1, -1, ProjectileType::SHELL, Side::ENEMY);
+                spawnProjectile(reg, row + 1, col + 1, 1, 1, ProjectileType::SHELL, Side::ENEMY);
+                ammo.shells -= 3;
+            }
+        }
+    }
+}
+
+// AI 远近分级（LOD）：按与玩家的行列距离决定隔几个移动间隔才处理一次。
+// 一屏之内（也就是视线范围，见 LineOfSight::kRange*）每个间隔都动；三屏之内每 4 个间隔、
+// 更远每 16 个间隔动一次，届时把落下的步数逐步补走，每一步照常检查障碍，与逐个间隔移动的结果一样。
+// 开火只在一屏之内登记：更远的敌舰本来就看不到玩家。
+bool inAiRange(const Position& pos, int playerRow, int playerCol) {
+    return std::abs(pos.row - playerRow) <= LineOfSight::kRangeRows &&
+           std::abs(pos.col - playerCol) <= LineOfSight::kRangeCols;
+}
+
+int aiLodSteps(const Position& pos, int playerRow, int playerCol, int moveInterval) {
+    const int dRow = std::abs(pos.row - playerRow);
+    const int dCol = std::abs(pos.col - playerCol);
+    if (dRow <= LineOfSight::kRangeRows && dCol <= LineOfSight::kRangeCols) return 1;
+    const int tier = dRow <= 3 * World::kDefaultRows && dCol <= 3 * World::kDefaultCols ? 4 : 16;
+    // 不能睡过玩家靠近的时刻：玩家每帧最多走一格、敌舰每个间隔最多走一格，
+    // 离一屏的边界还差 gap 格时，至少要过 gap × interval / (interval + 1) 帧才可能进入视线范围。
+    // 只睡这么多个间隔，醒来时重新分级，靠近的敌舰及时恢复逐间隔移动与开火
+    const int gap = std::max(dRow - LineOfSight::kRangeRows, dCol - LineOfSight::kRangeCols);
+    const int intervals = gap / (moveInterval + 1);
+    return std::clamp(intervals, 1, tier);
+}
+
+// 同一原型的一段到期动作 [begin, end)：移动方式是模板参数，开火方式与穿越障碍只查一次
+template <MovePattern Move>
+void runEnemyBatch(GameRegistry& reg, TimerWheel& timers,
+                   const EnemyAiSystem::Action* begin, const EnemyAiSystem::Action* end,
+                   int playerRow, int playerCol, const World& world, LineOfSight& sight) {
+    EnemyTable& t = reg.table<EnemyTable>();
+    Position* pos = t.column<Position>().data();
+    const Footprint* fp = t.column<Footprint>().data();
+    Ammo* ammo = t.column<Ammo>().data();
+    AiTimers* aiTimers = t.column<AiTimers>().data();
+    const EnemyInfo* info = t.column<EnemyInfo>().data();
+
+    const ArchetypeTable& arch = archetypes();
+    const std::uint8_t firePattern = arch.fire[begin->type];
+    const bool phasing = arch.phasing[begin->type] != 0;
+    const std::uint32_t tick = timers.now();
+
+    for (const EnemyAiSystem::Action* a = begin; a != end; ++a) {
+        const std::uint32_t r = a->row;
+        if (t.isDead(r)) continue;
+        AiTimers& tm = aiTimers[r];
+
+        if (a->kind == TimerKind::ENEMY_MOVE) {
+            // 远处的敌舰一次补走落下的几步：每一步都与逐个间隔移动一样检查障碍，撞上就退回这一步，
+            // 下一步接着试，不会穿过岛屿，也不会因为终点被挡住而整段作废
+            const Shape& shape = shapeOf(fp[r].shape);
+            bool leftArena = false;
+            for (int step = 0; step < tm.moveSteps && !leftArena; ++step) {
+                const Position prev = pos[r];
+                moveEnemy<Move>(pos[r], info[r], leftArena, playerRow, playerCol, world);
+                // Entities (except phasing ones such as Bomber) cannot move through obstacles.
+                if (!leftArena && !phasing && !canPlaceShape(world, pos[r].row, pos[r].col, shape)) {
+                    pos[r] = prev;
+                }
+            }
+            if (leftArena) {
+                t.markDead(r);
+                continue;
+            }
+            tm.moveSteps = aiLodSteps(pos[r], playerRow, playerCol, tm.moveInterval);
+            tm.nextMove = tick + (std::uint32_t)(tm.moveInterval * tm.moveSteps);
+            timers.schedule(tm.nextMove, TimerEvent{a->id, 0, TimerKind::ENEMY_MOVE});
+
+            // 回到一屏之内：恢复开火
+            if (tm.moveSteps == 1 && tm.nextFire == 0) {
+                tm.nextFire = tick + (std::uint32_t)tm.fireInterval;
+                timers.schedule(tm.nextFire, TimerEvent{a->id, 0, TimerKind::ENEMY_FIRE});
+            }
+        } else {
+            // 离开一屏：不再登记开火，等移动回来时恢复
+            if (!inAiRange(pos[r], playerRow, playerCol)) {
+                tm.nextFire = 0;
+                continue;
+            }
+            // 看不到玩家就不开火：隔着岛屿发射的投射物出生即被障碍销毁，只会白白消耗弹药
+            if (sight.seesTarget(pos[r].row, pos[r].col)) {
+                fireEnemy(reg, firePattern, pos[r], ammo[r], playerRow, playerCol);
+            }
+            tm.nextFire = tick + (std::uint32_t)tm.fireInterval;
+            timers.schedule(tm.nextFire, TimerEvent{a->id, 0, TimerKind::ENEMY_FIRE});
+        }
+    }
+}
+
+} // namespace
+
+void EnemyAiSystem::run(GameRegistry& reg, TimerWheel& timers, const std::vector<TimerEvent>& due,
+                        int playerRow, int playerCol, const World& world, LineOfSight& sight) {
+    const std::uint32_t tick = timers.now();
+    actions_.clear();
+    touched_.clear();
+
+    // 登记新敌舰：原先计时器从 0 开始、每帧先 +1 再判断，所以首次动作在本帧之后第 interval-1 帧
+    auto firstAction = [&](EntityId id, std::uint32_t& next, int interval, TimerKind kind) {
+        next = tick + (std::uint32_t)interval - 1;
+        if (next == tick) {
+            growingPush(actions_, Action{id, 0, 0, kind});
+        } else {
+            timers.schedule(next, TimerEvent{id, 0, kind});
+        }
+    };
+    for (EntityId id : pending_) {
+        if (!reg.alive(id)) continue;
+        AiTimers& tm = *reg.get<AiTimers>(id);
+        growingPush(touched_, id);
+        firstAction(id, tm.nextMove, tm.moveInterval, TimerKind::ENEMY_MOVE);
+        firstAction(id, tm.nextFire, tm.fireInterval, TimerKind::ENEMY_FIRE);
+    }
+    pending_.clear();
+
+    for (const TimerEvent& ev : due) {
+        if (ev.kind != TimerKind::ENEMY_MOVE && ev.kind != TimerKind::ENEMY_FIRE) continue;
+        growingPush(actions_, Action{ev.entity, 0, 0, ev.kind});
+    }
+
+    // 解析行号并丢弃已销毁敌舰的事件（懒删除）
+    const EnemyTable& t = reg.table<EnemyTable>();
+    std::size_t live = 0;
+    for (const Action& a : actions_) {
+        if (!reg.alive(a.id)) continue;
+        Action resolved = a;
+        resolved.row = reg.rowOf(a.id);
+        resolved.type = t.column<EnemyInfo>()[resolved.row].type;
+        actions_[live++] = resolved;
+        growingPush(touched_, a.id);
+    }
+    actions_.resize(live);
+
+    // 按 (原型, 行号, 先移动后开火) 排序：同原型连续成批，批内保持表顺序
+    std::sort(actions_.begin(), actions_.end(), [](const Action& a, const Action& b) {
+        if (a.type != b.type) return a.type < b.type;
+        if (a.row != b.row) return a.row < b.row;
+        return a.kind < b.kind;
+    });
+
+    const Action* first = actions_.data();
+    const Action* last = first + actions_.size();
+    while (first != last) {
+        const Action* end = first + 1;
+        while (end != last && end->type == first->type) ++end;
+
+        switch (archetypes().move[first->type]) {
+            case MovePattern::CHASE:
+                runEnemyBatch<MovePattern::CHASE>(reg, timers, first, end, playerRow, playerCol, world, sight);
+                break;
+            case MovePattern::STRAFE:
+                runEnemyBatch<MovePattern::STRAFE>(reg, timers, first, end, playerRow, playerCol, world, sight);
+                break;
+            case MovePattern::FLY:
+                runEnemyBatch<MovePattern::FLY>(reg, timers, first, end, playerRow, playerCol, world, sight);
+                break;
+        }
+        first = end;
+    }
+}
+
+void projectileSystem(GameRegistry& reg, const World& world) {
+    const ArchetypeTable& arch = archetypes();
+    reg.eachWithId<Position, Velocity, ProjectileInfo>(
+        [&](EntityId id, Position& pos, Velocity& vel, ProjectileInfo& info) {
+            info.prevRow = pos.row;
+            info.prevCol = pos.col;
+            info.steps = 0;
+            if (info.fresh) {
+                // 刚发射的投射物本帧不移动；出生在障碍里则直接销毁
+                info.fresh = false;
+                if (world.isBlocked(pos.row, pos.col)) reg.kill(id);
+                return;
+            }
+
+            info.lifeTime++;
+            if (info.type == ProjectileType::MISSILE && info.tracking) {
+                // 简单的追踪逻辑：每帧朝目标修正一次方向
+                if (pos.row < info.targetRow) vel.dRow = 1;
+                else if (pos.row > info.targetRow) vel.dRow = -1;
+                else vel.dRow = 0;
+
+                if (pos.col < info.targetCol) vel.dCol = 1;
+                else if (pos.col > info.targetCol) vel.dCol = -1;
+                else vel.dCol = 0;
+
+                // 导弹寿命限制，防止无限追踪
+                if (info.lifeTime > 30) reg.kill(id);
+            }
+
+            // 速度是八方向的单位向量，DDA 沿直线逐格前进即每步走一格；只检查地形，舰船留给碰撞系统沿路扫描
+            const int total = info.progress + arch.projectileSpeed[(int)info.type];
+            const int steps = total / kSpeedUnit;
+            info.progress = (std::uint8_t)(total % kSpeedUnit);
+            if (steps > 1) {
+                // 一帧走多格：整段路径的包围盒在障碍金字塔上查不到障碍，就不必逐格检查
+                const int endRow = pos.row + steps * vel.dRow;
+                const int endCol = pos.col + steps * vel.dCol;
+                if (world.inBounds(endRow, endCol) &&
+                    !world.mayBeBlocked(std::min(pos.row, endRow), std::min(pos.col, endCol),
+                                        std::abs(endRow - pos.row) + 1, std::abs(endCol - pos.col) + 1)) {
+                    pos.row = endRow;
+                    pos.col = endCol;
+                    info.steps = (std::uint8_t)steps;
+                    return;
+                }
+            }
+            for (int step = 0; step < steps; ++step) {
+                const int row = pos.row + vel.dRow;
+                const int col = pos.col + vel.dCol;
+                if (!world.inBounds(row, col) || world.isBlocked(row, col)) {
+                    info.blocked = true;
+                    break;
+                }
+                pos.row = row;
+                pos.col = col;
+                info.steps++;
+            }
+        });
+}
+
+namespace {
+
+// 投射物本帧经过的格子：从 prev 沿速度方向的 steps 格，fn 返回 true 时停止。
+// 这一帧没动（刚发射、慢速投射物攒不够一格）的只有当前格；一格没走就撞上障碍的没有
+template <typename Fn>
+void forEachSweptCell(const Position& pos, const Velocity& vel, const ProjectileInfo& info, Fn&& fn) {
+    if (info.steps == 0) {
+        if (!info.blocked) fn(pos.row, pos.col);
+        return;
+    }
+    int row = info.prevRow;
+    int col = info.prevCol;
+    for (int k = 0; k < info.steps; ++k) {
+        row += vel.dRow;
+        col += vel.dCol;
+        if (fn(row, col)) return;
+    }
+}
+
+// (row, col) 是否在投射物本帧走过的格子上（不含出发格）
+bool onSweptPath(const Velocity& vel, const ProjectileInfo& info, int row, int col) {
+    const int dr = row - info.prevRow;
+    const int dc = col - info.prevCol;
+    const int k = std::max(std::abs(dr), std::abs(dc));
+    return k >= 1 && k <= info.steps && dr == k * vel.dRow && dc == k * vel.dCol;
+}
+
+} // namespace
+
+void CollisionSystem::stamp(int row, int col, const Shape& shape, EntityId id) {
+    for (const ShapeCell& cell : shape.cells) {
+        const int r = row + cell.dr;
+        const int c = col + cell.dc;
+        if (r < 0 || r >= rows_ || c < 0 || c >= cols_) continue;
+        const int idx = r * cols_ + c;
+        // 后写入的排在链表头：链表顺序即命中优先级
+        growingPush(owners_, Owner{id, stamp_[idx] == tick_ ? head_[idx] : -1});
+        stamp_[idx] = tick_;
+        head_[idx] = (std::int32_t)owners_.size() - 1;
+    }
+}
+
+void CollisionSystem::interceptProjectiles(ProjectileTable& shots) {
+    const std::vector<Position>& pos = shots.column<Position>();
+    const std::vector<Velocity>& vel = shots.column<Velocity>();
+    const std::vector<ProjectileInfo>& info = shots.column<ProjectileInfo>();
+    const std::int32_t n = (std::int32_t)shots.size();
+    const ArchetypeTable& arch = archetypes();
+
+    // 按本帧经过的格子分桶，一次线性扫描；每枚投射物的记录连续存放
+    visits_.clear();
+    growingResize(visitBegin_, (std::size_t)n + 1);
+    for (std::int32_t r = 0; r < n; ++r) {
+        visitBegin_[r] = (std::int32_t)visits_.size();
+        if (shots.isDead(r)) continue;
+        forEachSweptCell(pos[r], vel[r], info[r], [&](int row, int col) {
+            if (row < 0 || row >= rows_ || col < 0 || col >= cols_) return false;
+            const int idx = row * cols_ + col;
+            growingPush(visits_, Visit{r, shotStamp_[idx] == tick_ ? shotHead_[idx] : -1, shots.id(r)});
+            shotStamp_[idx] = tick_;
+            shotHead_[idx] = (std::int32_t)visits_.size() - 1;
+            return false;
+        });
+    }
+    visitBegin_[n] = (std::int32_t)visits_.size();
+
+    // 敌对双方的两枚投射物，任一方的 intercepts 包含对方的类型即同归于尽；
+    // 同一方的（同一轮齐射从同一格出发、快的炮弹追上前面的导弹）互不影响
+    auto meet = [&](std::int32_t a, std::int32_t b) {
+        if (info[a].side == info[b].side) return;
+        const int ta = (int)info[a].type;
+        const int tb = (int)info[b].type;
+        if (!((arch.projectileIntercepts[ta] >> tb) & 1) && !((arch.projectileIntercepts[tb] >> ta) & 1)) return;
+        shots.markDead(a);
+        shots.markDead(b);
+    };
+
+    for (std::int32_t r = 0; r < n; ++r) {
+        if (shots.isDead(r)) continue;
+
+        // 经过同一格：与链表中排在后面（行号更小）的逐个配对，每对只从行号大的一方看
+        for (std::int32_t v = visitBegin_[r]; v < visitBegin_[r + 1] && !shots.isDead(r); ++v) {
+            for (std::int32_t o = visits_[v].next; o >= 0 && !shots.isDead(r); o = visits_[o].next) {
+                if (!shots.isDead(visits_[o].shot)) meet(r, visits_[o].shot);
+            }
+        }
+        if (shots.isDead(r)) continue;
+
+        // 交错而过：对方本帧经过我的出发格，我本帧经过对方的出发格（速度 1 时就是互换位置）
+        const int pr = info[r].prevRow;
+        const int pc = info[r].prevCol;
+        if (pr == pos[r].row && pc == pos[r].col) continue;
+        if (pr < 0 || pr >= rows_ || pc < 0 || pc >= cols_) continue;
+        const int prevIdx = pr * cols_ + pc;
+        if (shotStamp_[prevIdx] != tick_) continue;
+        for (std::int32_t v = shotHead_[prevIdx]; v >= 0 && !shots.isDead(r); v = visits_[v].next) {
+            const std::int32_t o = visits_[v].shot;
+            if (o == r || shots.isDead(o)) continue;
+            if (onSweptPath(vel[r], info[r], info[o].prevRow, info[o].prevCol)) meet(r, o);
+        }
+    }
+}
+
+EntityId CollisionSystem::shipAt(const GameRegistry& reg, int idx) const {
+    // 本帧已被击毁的敌舰跳过，沿链表找下一艘覆盖该格的存活舰船
+    if (stamp_[idx] != tick_) return EntityId{};
+    std::int32_t o = head_[idx];
+    while (o >= 0 && reg.isDead(owners_[o].id)) o = owners_[o].next;
+    return o >= 0 ? owners_[o].id : EntityId{};
+}
+
+bool CollisionSystem::covers(int idx, EntityId id) const {
+    if (stamp_[idx] != tick_) return false;
+    for (std::int32_t o = head_[idx]; o >= 0; o = owners_[o].next) {
+        if (owners_[o].id == id) return true;
+    }
+    return false;
+}
+
+EntityId CollisionSystem::sweepShips(const GameRegistry& reg, const Position& pos, const Velocity& vel,
+                                     const ProjectileInfo& info) const {
+    const bool startInside = info.prevRow >= 0 && info.prevRow < rows_ && info.prevCol >= 0 && info.prevCol < cols_;
+    const int startIdx = startInside ? info.prevRow * cols_ + info.prevCol : -1;
+    EntityId hit;
+    forEachSweptCell(pos, vel, info, [&](int row, int col) {
+        if (row < 0 || row >= rows_ || col < 0 || col >= cols_) return true;
+        const int idx = row * cols_ + col;
+        hit = shipAt(reg, idx);
+        if (hit.valid() || info.steps == 0 || startIdx < 0) return hit.valid();
+
+        // 这一格上一帧有舰船、它这一帧又移到了投射物的出发格：两者迎面交错，同样算命中
+        if (prevStamp_[idx] != tick_ - 1) return false;
+        for (std::int32_t o = prevHead_[idx]; o >= 0; o = prevOwners_[o].next) {
+            const EntityId ship = prevOwners_[o].id;
+            if (!reg.isDead(ship) && covers(startIdx, ship)) {
+                hit = ship;
+                return true;
+            }
+        }
+        return false;
+    });
+    return hit;
+}
+
+void CollisionSystem::damage(GameRegistry& reg, EntityId target, int amount, int cause, int row, int col) {
+    if (amount <= 0) return;
+    if (target == player_) {
+        Health& hp = *reg.get<Health>(player_);
+        hp.hp -= amount;
+        if (events_) events_->record(EventKind::PLAYER_HIT, cause, row, col, amount, hp.hp);
+        return;
+    }
+    const ArchetypeTable& arch = archetypes();
+    const EnemyType type = reg.get<EnemyInfo>(target)->type;
+    if (arch.invincible[type]) return; // e.g. Bomber
+    Health& hp = *reg.get<Health>(target);
+    hp.hp -= amount;
+    growingPush(struck_, target);
+    if (hp.hp > 0) {
+        if (events_) events_->record(EventKind::ENEMY_HIT, type, row, col, amount, hp.hp);
+        return;
+    }
+    reg.kill(target);
+    reg.get<PlayerState>(player_)->coins += arch.score[type];
+    if (events_) events_->record(EventKind::ENEMY_KILLED, type, row, col, arch.score[type]);
+    if (arch.chainRadius[type] > 0) {
+        const Position& pos = *reg.get<Position>(target);
+        growingPush(blasts_, Blast{pos.row, pos.col, arch.chainDamage[type], arch.chainRadius[type], (std::uint8_t)cause, target});
+    }
+}
+
+void CollisionSystem::detonate(GameRegistry& reg, std::size_t from) {
+    // blasts_ 在循环中会增长，按下标访问并拷贝出来
+    for (std::size_t i = from; i < blasts_.size(); ++i) {
+        const Blast blast = blasts_[i];
+        const int r = blast.radius;
+        const int top = std::max(blast.row - r, 0);
+        const int bottom = std::min(blast.row + r, rows_ - 1);
+        const int left = std::max(blast.col - 2 * r, 0);
+        const int right = std::min(blast.col + 2 * r, cols_ - 1);
+
+        // 先收集再结算：结算中被击毁的舰船仍按爆炸那一刻的范围计算，不受遍历顺序影响
+        victims_.clear();
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                const int idx = row * cols_ + col;
+                if (stamp_[idx] != tick_) continue;
+                const int d = std::max(std::abs(row - blast.row), (std::abs(col - blast.col) + 1) / 2);
+                if (d > r) continue;
+                for (std::int32_t o = head_[idx]; o >= 0; o = owners_[o].next) {
+                    const EntityId id = owners_[o].id;
+                    if (id == blast.skip || reg.isDead(id)) continue;
+                    auto it = std::find_if(victims_.begin(), victims_.end(), [&](const auto& v) { return v.first == id; });
+                    if (it == victims_.end()) growingPush(victims_, id, d);
+                    else it->second = std::min(it->second, d);
+                }
+            }
+        }
+        for (const auto& [id, d] : victims_) {
+            if (reg.isDead(id)) continue;
+            damage(reg, id, blast.damage * (r + 1 - d) / (r + 1), blast.cause, blast.row, blast.col);
+        }
+    }
+}
+
+void CollisionSystem::run(GameRegistry& reg, EntityId player, const World& world) {
+    ++tick_;
+    if (world.rows() != rows_ || world.cols() != cols_) {
+        rows_ = world.rows();
+        cols_ = world.cols();
+        stamp_.assign((std::size_t)rows_ * cols_, 0);
+        head_.assign((std::size_t)rows_ * cols_, -1);
+        prevStamp_.assign((std::size_t)rows_ * cols_, 0);
+        prevHead_.assign((std::size_t)rows_ * cols_, -1);
+        shotStamp_.assign((std::size_t)rows_ * cols_, 0);
+        shotHead_.assign((std::size_t)rows_ * cols_, -1);
+        pickupStamp_.assign((std::size_t)rows_ * cols_, 0);
+        pickupHead_.assign((std::size_t)rows_ * cols_, -1);
+    }
+    // 本帧的占格表成为上一帧的，两套缓冲区轮换使用
+    std::swap(stamp_, prevStamp_);
+    std::swap(head_, prevHead_);
+    std::swap(owners_, prevOwners_);
+    owners_.clear();
+    struck_.clear();
+    impacts_.clear();
+    blasts_.clear();
+    player_ = player;
+
+    // 先结算投射物之间的拦截：在空中相遇的两枚投射物不会再打到舰船
+    interceptProjectiles(reg.table<ProjectileTable>());
+
+    // 舰船占格：敌舰倒序写入、玩家最后写入，使重叠时“玩家优先、其次表中靠前的敌舰”，与逐个检测的顺序一致
+    EnemyTable& enemies = reg.table<EnemyTable>();
+    const std::vector<Position>& enemyPos = enemies.column<Position>();
+    const std::vector<Footprint>& enemyFp = enemies.column<Footprint>();
+    for (std::size_t r = enemies.size(); r-- > 0;) {
+        if (enemies.isDead(r)) continue;
+        stamp(enemyPos[r].row, enemyPos[r].col, shapeOf(enemyFp[r].shape), enemies.id(r));
+    }
+    const Position& playerPos = *reg.get<Position>(player);
+    stamp(playerPos.row, playerPos.col, shapeOf(reg.get<Footprint>(player)->shape), player);
+
+    Health& playerHp = *reg.get<Health>(player);
+    const ArchetypeTable& arch = archetypes();
+
+    // Projectile vs Ships：沿本帧走过的格子扫描，快速投射物也不会穿过舰船
+    reg.eachWithId<Position, Velocity, ProjectileInfo>([&](EntityId pid, Position& p, Velocity& v, ProjectileInfo& info) {
+        const int type = (int)info.type;
+        const EntityId target = sweepShips(reg, p, v, info);
+        if (!target.valid() && !info.blocked) return;
+        reg.kill(pid);
+        if (target.valid()) {
+            damage(reg, target, arch.projectileDamage[type], type, p.row, p.col);
+        } else {
+            // 扫描完才销毁撞上障碍的投射物
+            growingPush(impacts_, pid);
+        }
+        // 爆炸与殉爆在下一枚投射物之前结算完：被炸沉的舰船不会再挡住后面的投射物
+        const std::size_t from = blasts_.size();
+        if (arch.projectileBlast[type] > 0) {
+            growingPush(blasts_, Blast{p.row, p.col, arch.projectileDamage[type], arch.projectileBlast[type], (std::uint8_t)type, target});
+        }
+        detonate(reg, from);
+    });
+
+    // Player vs Pickups (Range +/- 1)；没被拾取的顺带分桶，供 forEachPickupIn 查询
+    Ammo& playerAmmo = *reg.get<Ammo>(player);
+    pickups_.clear();
+    reg.eachWithId<Position, PickupInfo>([&](EntityId id, Position& pu, PickupInfo& info) {
+        if (std::abs(playerPos.row - pu.row) > 1 || std::abs(playerPos.col - pu.col) > 1) {
+            if (pu.row < 0 || pu.row >= rows_ || pu.col < 0 || pu.col >= cols_) return;
+            const int idx = pu.row * cols_ + pu.col;
+            growingPush(pickups_, Owner{id, pickupStamp_[idx] == tick_ ? pickupHead_[idx] : -1});
+            pickupStamp_[idx] = tick_;
+            pickupHead_[idx] = (std::int32_t)pickups_.size() - 1;
+            return;
+        }
+        if (info.type == PickupType::WEAPON) {
+            playerAmmo.shells += 20;
+            playerAmmo.missiles += 1;
+        } else {
+            playerHp.hp += 100;
+            if (playerHp.hp > playerHp.maxHp) playerHp.hp = playerHp.maxHp;
+        }
+        if (events_) events_->record(EventKind::PICKUP, (int)info.type, pu.row, pu.col, 0, playerHp.hp);
+        reg.kill(id);
+    });
+}
+
+void renderSystem(const GameRegistry& reg, Renderer& renderer, const FieldOfView* fog) {
+    auto draw = [&](const Position& pos, const Footprint& fp, const Color& color) {
+        renderer.drawShape(pos.row, pos.col, shapeOf(fp.shape), color.pair);
+    };
+    if (!fog) {
+        reg.each<Position, Footprint, Color>(draw);
+        return;
+    }
+
+    // 按表逐个绘制，保持与上面相同的顺序；敌舰外形有任意一格在视野内才画
+    reg.each<Position, Footprint, Color, PlayerState>(
+        [&](const Position& pos, const Footprint& fp, const Color& color, const PlayerState&) { draw(pos, fp, color); });
+    reg.each<Position, Footprint, Color, EnemyInfo>(
+        [&](const Position& pos, const Footprint& fp, const Color& color, const EnemyInfo&) {
+            if (fog->anyVisible(pos.row, pos.col, shapeOf(fp.shape))) draw(pos, fp, color);
+        });
+    reg.each<Position, Footprint, Color, ProjectileInfo>(
+        [&](const Position& pos, const Footprint& fp, const Color& color, const ProjectileInfo&) { draw(pos, fp, color); });
+    reg.each<Position, Footprint, Color, PickupInfo>(
+        [&](const Position& pos, const Footprint& fp, const Color& color, const PickupInfo&) { draw(pos, fp, color); });
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "components.h"
+#include "input_manager.h"
+#include "world.h"
+#include "renderer.h"
+#include "timer_wheel.h"
+#include "line_of_sight.h"
+#include "event_log.h"
+
+// 系统：每个系统只通过 Registry 读写自己用到的组件列。
+// 调用顺序（见 Game::update）：玩家操控 → 时间轮到期事件（刷怪、玩家回复、敌舰 AI）→ 投射物 → 碰撞 → 清理。
+
+// 外形能否整体放在 (row, col)：所有非空格占格都在界内且不是障碍
+bool canPlaceShape(const World& world, int row, int col, const Shape& shape);
+
+// 从 (row, col) 起由近及远查找外形能放下的位置（最远 maxRadius 格），找到时改写 row/col 并返回 true
+bool findFreePlacement(const World& world, int& row, int& col, const Shape& shape, int maxRadius);
+
+// 地形热重载后：被新障碍埋住的实体挪到附近空位或移除
+constexpr int kTerrainNudgeRadius = 8;
+// 撞上岛屿的投射物按原型的 erode 削掉陆地，改动记入 World 的脏集合
+void erosionSystem(const GameRegistry& reg, World& world, const std::vector<EntityId>& impacts);
+void terrainChangedSystem(GameRegistry& reg, EntityId player, const World& world, const std::vector<CellChange>& changes);
+
+// 玩家移动与开火（原 PlayerShip::handleInput）
+void playerControlSystem(GameRegistry& reg, EntityId player, const InputState& input, const World& world);
+
+// 敌舰 AI（原 EnemyShip::aiUpdate）。每艘敌舰把下一次移动/开火的帧号登记在时间轮上，
+// 每帧只处理到期的敌舰；到期动作按行号排序后按原型成批分派。
+class EnemyAiSystem {
+public:
+    // 新刷出的敌舰：在下一次 run 时登记，首次移动/开火与原先“每帧计时器 +1”的节奏一致
+    void track(EntityId id) { growingPush(pending_, id); }
+    void clear() { pending_.clear(); }
+
+    // due 为时间轮本帧（timers.now()）到期的事件，只处理其中的 ENEMY_MOVE / ENEMY_FIRE；
+    // sight 需已在本帧以玩家位置 beginTick，开火前用它判断能否看到玩家
+    void run(GameRegistry& reg, TimerWheel& timers, const std::vector<TimerEvent>& due,
+             int playerRow, int playerCol, const World& world, LineOfSight& sight);
+
+    // 本次 run 登记过计时或行动过的敌舰（可能已在本帧被销毁）
+    const std::vector<EntityId>& touched() const { return touched_; }
+
+    struct Action {
+        EntityId id;
+        std::uint32_t row;
+        EnemyType type;
+        TimerKind kind;
+    };
+
+private:
+    std::vector<EntityId> pending_;
+    std::vector<Action> actions_;
+    std::vector<EntityId> touched_;
+};
+
+// 投射物移动：按各类型的速度每帧走若干格，途中出界或撞障碍就停在前一格并标记 blocked，
+// 由碰撞系统扫描完走过的格子后销毁
+void projectileSystem(GameRegistry& reg, const World& world);
+
+// 投射物 vs 舰船、玩家 vs 道具（原 Game::checkCollisions）。
+// 每帧把舰船占格写入一张按帧号标记的格子表，投射物只需查一次格子。
+// 重叠的舰船在格子上串成链表（按命中优先级），本帧先被击毁的舰船直接沿链表跳过。
+// 带 blast 的投射物命中或撞上障碍时爆炸，带 chain 的敌舰被击毁时殉爆：波及范围同样在这张格子表上查，
+// 只看爆炸周围的 (2R+1)×(4R+1) 格，与场上舰船的总数无关。
+class CollisionSystem {
+public:
+    struct Blast {
+        std::int32_t row;
+        std::int32_t col;
+        std::int32_t damage;  // 中心伤害，距离 d 处为 damage × (R + 1 - d) / (R + 1)
+        std::uint8_t radius;
+        std::uint8_t cause;   // 引发爆炸的投射物类型（殉爆沿用最初那一枚的），写进事件日志
+        EntityId skip;        // 不再波及的舰船（已被直接命中的那艘）
+    };
+
+    void run(GameRegistry& reg, EntityId player, const World& world);
+    // 受伤、击毁与拾取道具写进事件日志；nullptr 时不记录
+    void setEventLog(EventLog* events) { events_ = events; }
+
+    // 本次 run 中受到伤害的敌舰（可能已被击毁）
+    const std::vector<EntityId>& struck() const { return struck_; }
+    // 本次 run 中撞上障碍（没有先打中舰船）而销毁的投射物
+    const std::vector<EntityId>& impacts() const { return impacts_; }
+    // 本次 run 中发生的爆炸（含殉爆），按发生顺序
+    const std::vector<Blast>& blasts() const { return blasts_; }
+
+    // 查询最近一次 run 的舰船占格表：对 [top, bottom] × [left, right] 内每格上的存活舰船（含玩家）
+    // 按命中优先级调用 fn(id, row, col)，fn 返回 true 时停止。一艘占多格会回调多次。
+    // 自动驾驶用它找附近的敌舰，代价与查询的格数成正比，不必遍历整张敌舰表
+    template <typename Fn>
+    void forEachShipIn(const GameRegistry& reg, int top, int left, int bottom, int right, Fn&& fn) const {
+        top = std::max(top, 0);
+        left = std::max(left, 0);
+        bottom = std::min(bottom, rows_ - 1);
+        right = std::min(right, cols_ - 1);
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                const int idx = row * cols_ + col;
+                if (stamp_[idx] != tick_) continue;
+                for (std::int32_t o = head_[idx]; o >= 0; o = owners_[o].next) {
+                    if (!reg.isDead(owners_[o].id) && fn(owners_[o].id, row, col)) return;
+                }
+            }
+        }
+    }
+
+    // 查询最近一次 run 的投射物分桶：对 [top, bottom] × [left, right] 内每格上本帧经过的存活投射物调用 fn(id)，
+    // fn 返回 true 时停止。一枚走过多格会回调多次；存活的投射物都在它的当前格上
+    template <typename Fn>
+    void forEachShotIn(const GameRegistry& reg, int top, int left, int bottom, int right, Fn&& fn) const {
+        top = std::max(top, 0);
+        left = std::max(left, 0);
+        bottom = std::min(bottom, rows_ - 1);
+        right = std::min(right, cols_ - 1);
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                const int idx = row * cols_ + col;
+                if (shotStamp_[idx] != tick_) continue;
+                for (std::int32_t v = shotHead_[idx]; v >= 0; v = visits_[v].next) {
+                    if (!reg.isDead(visits_[v].id) && fn(visits_[v].id)) return;
+                }
+            }
+        }
+    }
+
+    // 查询最近一次 run 之后还在场上的道具：对矩形内每个道具调用 fn(id, row, col)，fn 返回 true 时停止
+    template <typename Fn>
+    void forEachPickupIn(const GameRegistry& reg, int top, int left, int bottom, int right, Fn&& fn) const {
+        top = std::max(top, 0);
+        left = std::max(left, 0);
+        bottom = std::min(bottom, rows_ - 1);
+        right = std::min(right, cols_ - 1);
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                const int idx = row * cols_ + col;
+                if (pickupStamp_[idx] != tick_) continue;
+                for (std::int32_t o = pickupHead_[idx]; o >= 0; o = pickups_[o].next) {
+                    if (!reg.isDead(pickups_[o].id) && fn(pickups_[o].id, row, col)) return;
+                }
+            }
+        }
+    }
+
+private:
+    struct Owner {
+        EntityId id;
+        std::int32_t next; // 同一格的下一艘舰船，-1 表示没有
+    };
+
+    struct Visit {
+        std::int32_t shot; // ProjectileTable 行号
+        std::int32_t next; // 同一格的下一条经过记录，-1 表示没有
+        EntityId id;       // 供 forEachShotIn 查询：行号在帧末清理死亡实体后会变
+    };
+
+    void stamp(int row, int col, const Shape& shape, EntityId id);
+    void interceptProjectiles(ProjectileTable& shots);
+    // 沿投射物本帧走过的格子找第一艘命中的舰船；没有返回无效句柄
+    EntityId sweepShips(const GameRegistry& reg, const Position& pos, const Velocity& vel,
+                        const ProjectileInfo& info) const;
+    // 该格第一艘本帧存活的舰船（本帧 / 上一帧的占格）
+    EntityId shipAt(const GameRegistry& reg, int idx) const;
+    bool covers(int idx, EntityId id) const; // 本帧 id 的外形是否覆盖该格
+    // 对一艘舰船造成伤害并记事件；敌舰被击毁时计金币，带 chain 的排一次殉爆
+    void damage(GameRegistry& reg, EntityId target, int amount, int cause, int row, int col);
+    // 依次结算 blasts_ 中 from 之后的爆炸，结算中新排的殉爆接在后面一并结算
+    void detonate(GameRegistry& reg, std::size_t from);
+
+    std::uint32_t tick_ = 0;
+    int rows_ = 0;
+    int cols_ = 0;
+    std::vector<std::uint32_t> stamp_; // 本帧被占据的格子（值为 tick_）
+    std::vector<std::int32_t> head_;   // 该格链表头在 owners_ 中的下标
+    std::vector<Owner> owners_;        // 本帧所有占格记录
+    // 上一帧的占格（与上面三项每帧交换）：舰船与投射物互换位置、擦身穿过时靠它发现
+    std::vector<std::uint32_t> prevStamp_;
+    std::vector<std::int32_t> prevHead_;
+    std::vector<Owner> prevOwners_;
+    std::vector<EntityId> struck_;
+    std::vector<EntityId> impacts_;
+    std::vector<Blast> blasts_;
+    std::vector<std::pair<EntityId, int>> victims_; // 一次爆炸波及的舰船与最近的距离（舰船占多格，需去重）
+    EntityId player_;
+    EventLog* events_ = nullptr;
+
+    // 投射物按本帧经过的格子分桶：每经过一格一条记录，同一格的记录串成链表，与舰船占格同样用 tick_ 免清空
+    std::vector<std::uint32_t> shotStamp_;
+    std::vector<std::int32_t> shotHead_;    // 该格链表头在 visits_ 中的下标
+    std::vector<Visit> visits_;
+    std::vector<std::int32_t> visitBegin_;  // 按行号：该投射物的记录在 visits_ 中的起点（共 n + 1 项）
+
+    // 没被拾取的道具按格分桶（道具只占一格），同样用 tick_ 免清空
+    std::vector<std::uint32_t> pickupStamp_;
+    std::vector<std::int32_t> pickupHead_; // 该格链表头在 pickups_ 中的下标
+    std::vector<Owner> pickups_;
+};
+
+// 绘制所有带外形的实体（表顺序即绘制顺序）；fog 非空时视野外的敌舰不画
+void renderSystem(const GameRegistry& reg, Renderer& renderer, const FieldOfView* fog = nullptr);
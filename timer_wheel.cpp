@@ -0,0 +1,92 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel() {
+    clear();
+}
+
+void TimerWheel::clear() {
+    nodes_.clear();
+    freeList_ = -1;
+    overflow_ = -1;
+    pending_ = 0;
+    for (auto& level : slots_) {
+        for (auto& head : level) head = -1;
+    }
+}
+
+void TimerWheel::schedule(std::uint32_t due, const TimerEvent& ev) {
+    std::int32_t node;
+    if (freeList_ >= 0) {
+        node = freeList_;
+        freeList_ = nodes_[node].next;
+    } else {
+        node = (std::int32_t)nodes_.size();
+        growingPush(nodes_, Node{});
+    }
+    nodes_[node].ev = ev;
+    nodes_[node].due = due;
+    insert(node);
+    ++pending_;
+}
+
+void TimerWheel::insert(std::int32_t node) {
+    const std::uint32_t due = nodes_[node].due;
+    // 放到与 now_ 第一个不同的 6 位组所在的层：该组开始的那一帧会把它下沉到更低层
+    for (int level = 0; level < kLevels; ++level) {
+        const int shift = kSlotBits * (level + 1);
+        if ((due >> shift) == (now_ >> shift)) {
+            std::int32_t& head = slots_[level][(due >> (kSlotBits * level)) & (kSlots - 1)];
+            nodes_[node].next = head;
+            head = node;
+            return;
+        }
+    }
+    nodes_[node].next = overflow_;
+    overflow_ = node;
+}
+
+void TimerWheel::cascade(int level, int slot) {
+    std::int32_t node = slots_[level][slot];
+    slots_[level][slot] = -1;
+    while (node >= 0) {
+        const std::int32_t next = nodes_[node].next;
+        insert(node);
+        node = next;
+    }
+}
+
+void TimerWheel::advance(std::vector<TimerEvent>& out) {
+    ++now_;
+
+    // 低层转完一圈时，从高层取出下一段时间的事件重新分配
+    if ((now_ & (kSlots - 1)) == 0) {
+        for (int level = 1; level < kLevels; ++level) {
+            if (((now_ >> (kSlotBits * level)) & (kSlots - 1)) != 0) {
+                // 只需处理 1..level 层：由高到低下沉
+                for (int l = level; l >= 1; --l) cascade(l, (now_ >> (kSlotBits * l)) & (kSlots - 1));
+                break;
+            }
+            if (level == kLevels - 1) {
+                std::int32_t node = overflow_;
+                overflow_ = -1;
+                while (node >= 0) {
+                    const std::int32_t next = nodes_[node].next;
+                    insert(node);
+                    node = next;
+                }
+                for (int l = level; l >= 1; --l) cascade(l, (now_ >> (kSlotBits * l)) & (kSlots - 1));
+            }
+        }
+    }
+
+    std::int32_t node = slots_[0][now_ & (kSlots - 1)];
+    slots_[0][now_ & (kSlots - 1)] = -1;
+    while (node >= 0) {
+        const std::int32_t next = nodes_[node].next;
+        growingPush(out, nodes_[node].ev);
+        nodes_[node].next = freeList_;
+        freeList_ = node;
+        --pending_;
+        node = next;
+    }
+}
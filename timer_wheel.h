@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ecs.h"
+
+enum class TimerKind : std::uint8_t {
+    // 按处理顺序排列：同一帧到期的事件按此顺序分派
+    PLAYER_SHELL_REGEN,
+    PLAYER_MISSILE_REGEN,
+    ENEMY_MOVE,
+    ENEMY_FIRE,
+    SCRIPT // 只出现在 ScriptScheduler 自己的时间轮上
+};
+
+struct TimerEvent {
+    EntityId entity;         // 实体事件的目标；实体已销毁时事件视为作废
+    std::uint32_t epoch = 0; // 非实体事件用来识别过期的登记
+    TimerKind kind = TimerKind::ENEMY_MOVE;
+};
+
+// 分层时间轮：4 层 × 64 槽，每层覆盖上一层的 64 倍时间跨度。
+// 登记与到期都是 O(1)（跨层下沉摊还），每帧只触碰当帧到期的事件，
+// 大量“还没到时间”的实体不产生任何开销。
+class TimerWheel {
+public:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+
+    TimerWheel();
+
+    std::uint32_t now() const { return now_; }
+    std::size_t pending() const { return pending_; }
+
+    // 登记一个在 due 帧触发的事件；due 必须晚于 now()
+    void schedule(std::uint32_t due, const TimerEvent& ev);
+
+    // 前进一帧（now()+1），把该帧到期的事件追加到 out
+    void advance(std::vector<TimerEvent>& out);
+
+    // 丢弃所有事件，时间保持不变
+    void clear();
+
+private:
+    struct Node {
+        TimerEvent ev;
+        std::uint32_t due = 0;
+        std::int32_t next = -1;
+    };
+
+    void insert(std::int32_t node);
+    void cascade(int level, int slot);
+
+    std::uint32_t now_ = 0;
+    std::size_t pending_ = 0;
+    std::vector<Node> nodes_;
+    std::int32_t freeList_ = -1;
+    std::int32_t slots_[kLevels][kSlots];
+    std::int32_t overflow_ = -1; // 超出最高层跨度的事件
+};
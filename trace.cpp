@@ -0,0 +1,63 @@
+#include "trace.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+const char* const kArgsPrefix = "# args:";
+}
+
+bool saveTrace(const std::string& path, const Trace& trace) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << kArgsPrefix;
+    for (const std::string& arg : trace.args) out << ' ' << arg;
+    out << '\n';
+    char line[48];
+    for (std::size_t i = 0; i < trace.hashes.size(); ++i) {
+        std::snprintf(line, sizeof(line), "%zu %016llx\n", i, (unsigned long long)trace.hashes[i]);
+        out << line;
+    }
+    return (bool)out;
+}
+
+bool loadTrace(const std::string& path, Trace* out, std::string* error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        if (error) *error = "cannot open";
+        return false;
+    }
+
+    Trace trace;
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, std::string(kArgsPrefix).size(), kArgsPrefix) != 0) {
+        if (error) *error = "missing '# args:' header";
+        return false;
+    }
+    std::istringstream header(line.substr(std::string(kArgsPrefix).size()));
+    std::string arg;
+    while (header >> arg) trace.args.push_back(arg);
+
+    int lineNo = 1;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.empty()) continue;
+        unsigned long long tick = 0;
+        unsigned long long hash = 0;
+        if (std::sscanf(line.c_str(), "%llu %llx", &tick, &hash) != 2 || tick != trace.hashes.size()) {
+            if (error) *error = "line " + std::to_string(lineNo) + ": expected '<tick> <hash>'";
+            return false;
+        }
+        trace.hashes.push_back(hash);
+    }
+    *out = std::move(trace);
+    return true;
+}
+
+long firstDivergence(const std::vector<std::uint64_t>& expected, const std::vector<std::uint64_t>& actual) {
+    const std::size_t n = expected.size() < actual.size() ? expected.size() : actual.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (expected[i] != actual[i]) return (long)i;
+    }
+    return expected.size() == actual.size() ? -1 : (long)n;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 状态哈希轨迹：无终端运行时每帧记录一次 Game::stateHash()。
+// 金标准轨迹放在 golden/ 下，用 --check-golden 重放比对，确认优化没有改变玩法。
+// 文件格式：第一行 "# args: <生成时的命令行参数>"，其后每行 "<帧号> <16 位十六进制哈希>"。
+struct Trace {
+    std::vector<std::string> args;
+    std::vector<std::uint64_t> hashes;
+};
+
+bool saveTrace(const std::string& path, const Trace& trace);
+// 文件无法读取或格式不对时返回 false，并在 error 中给出原因
+bool loadTrace(const std::string& path, Trace* out, std::string* error);
+
+// 第一个不一致的帧号；完全一致返回 -1。长度不同时较短一方结束的位置算作分歧
+long firstDivergence(const std::vector<std::uint64_t>& expected, const std::vector<std::uint64_t>& actual);
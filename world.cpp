@@ -1,73 +1,199 @@
 #include "world.h"
+#include "alloc_tracker.h"
+#include "rng.h"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 
-World::World() {
+World::World()
+    : rows_(0), cols_(0), rowWords_(0) {
+    clearAll();
+}
+
+World::World(int rows, int cols, const IslandParams& islands)
+    : rows_(rows), cols_(cols), rowWords_((cols + 63) / 64) {
     clearAll();
 
-    // No map specified: generate random obstacles.
-    generateRandomObstacles();
+    // No map specified: generate random islands.
+    generateIslands(islands);
 
     // Always keep a safe spawn area.
     clearSpawnArea();
 }
 
-World::World(const std::string& mapFilePath) {
+World::World(const std::string& mapFilePath)
+    : rows_(kDefaultRows), cols_(kDefaultCols), rowWords_((kDefaultCols + 63) / 64) {
     clearAll();
 
     // Map specified: try loading it. If it fails, fall back to random.
     if (!loadFromFile(mapFilePath)) {
-        generateRandomObstacles();
+        generateIslands(IslandParams{gameRng().next()});
     }
 
     clearSpawnArea();
 }
 
+std::uint64_t World::cellKey(int index) {
+    // splitmix64：每格一个固定的随机键，障碍格的键异或起来就是地形哈希
+    std::uint64_t z = (std::uint64_t)index * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
 void World::clearAll() {
-    for (int r = 0; r < kRows; ++r) {
-        for (int c = 0; c < kCols; ++c) {
-            obstacles_[r][c] = false;
+    obstacles_.assign((std::size_t)rows_ * cols_, 0);
+    rowBits_.assign((std::size_t)rows_ * rowWords_, 0);
+    terrainHash_ = 0;
+    buildPyramid();
+}
+
+void World::buildPyramid() {
+    int size = 0;
+    for (int level = 1; level <= kPyramidLevels; ++level) {
+        levelOffset_[level] = size;
+        size += blockRows(level) * blockCols(level);
+    }
+    pyramid_.assign((std::size_t)size, 0);
+    // 第 1 层直接数格子，之后每层由上一层的 2 × 2 块相加
+    const int cols1 = blockCols(1);
+    for (int r = 0; r < rows_; ++r) {
+        for (int c = 0; c < cols_; ++c) {
+            if (obstacles_[r * cols_ + c]) pyramid_[levelOffset_[1] + (r >> 1) * cols1 + (c >> 1)]++;
+        }
+    }
+    for (int level = 2; level <= kPyramidLevels; ++level) {
+        const int below = levelOffset_[level - 1];
+        const int belowRows = blockRows(level - 1);
+        const int belowCols = blockCols(level - 1);
+        const int cols = blockCols(level);
+        for (int r = 0; r < belowRows; ++r) {
+            for (int c = 0; c < belowCols; ++c) {
+                pyramid_[levelOffset_[level] + (r >> 1) * cols + (c >> 1)] += pyramid_[below + r * belowCols + c];
+            }
+        }
+    }
+}
+
+bool World::mayBeBlocked(int top, int left, int height, int width) const {
+    int bottom = std::min(rows_, top + height) - 1;
+    int right = std::min(cols_, left + width) - 1;
+    top = std::max(0, top);
+    left = std::max(0, left);
+    if (top > bottom || left > right) return false;
+    if (top == bottom && left == right) return obstacles_[top * cols_ + left] != 0;
+
+    // 边长不小于矩形的最低一层：矩形每个方向最多跨 2 个块；超过顶层的大矩形就多查几块
+    const int size = std::max(bottom - top, right - left) + 1;
+    int level = 1;
+    while (level < kPyramidLevels && (1 << level) < size) ++level;
+    const int cols = blockCols(level);
+    for (int br = top >> level; br <= bottom >> level; ++br) {
+        for (int bc = left >> level; bc <= right >> level; ++bc) {
+            if (pyramid_[levelOffset_[level] + br * cols + bc]) return true;
         }
     }
+    return false;
 }
 
-void World::generateRandomObstacles() {
-    // Random obstacles (Islands)
-    // Keep top/bottom areas clearer to reduce unavoidable collisions.
-    for (int r = 5; r < kRows - 5; ++r) {
-        for (int c = 0; c < kCols; ++c) {
-            if (std::rand() % 20 == 0) { // 5% chance
-                obstacles_[r][c] = true;
+bool World::anyBlocked(int top, int left, int height, int width) const {
+    if (!mayBeBlocked(top, left, height, width)) return false;
+    int bottom = std::min(rows_, top + height) - 1;
+    int right = std::min(cols_, left + width) - 1;
+    top = std::max(0, top);
+    left = std::max(0, left);
+
+    // 被矩形完全盖住的块里有障碍就一定有
+    for (int level = kPyramidLevels; level >= 1; --level) {
+        const int side = 1 << level;
+        const int br0 = (top + side - 1) >> level;
+        const int bc0 = (left + side - 1) >> level;
+        const int br1 = ((bottom + 1) >> level) - 1;
+        const int bc1 = ((right + 1) >> level) - 1;
+        if (br0 > br1 || bc0 > bc1) continue;
+        const int cols = blockCols(level);
+        for (int br = br0; br <= br1; ++br) {
+            for (int bc = bc0; bc <= bc1; ++bc) {
+                if (pyramid_[levelOffset_[level] + br * cols + bc]) return true;
             }
         }
+        break; // 更低的层块数成倍增加，不如直接查位图
+    }
+
+    for (int r = top; r <= bottom; ++r) {
+        for (int w = left / 64; w <= right / 64; ++w) {
+            const int a = std::max(left, w * 64) - w * 64;
+            const int b = std::min(right, w * 64 + 63) - w * 64;
+            const int width = b - a + 1;
+            const std::uint64_t mask = (width == 64 ? ~std::uint64_t{0} : ((std::uint64_t{1} << width) - 1)) << a;
+            if (rowBits_[r * rowWords_ + w] & mask) return true;
+        }
     }
+    return false;
 }
 
-void World::clearSpawnArea() {
+void World::setObstacle(int row, int col, bool blocked) {
+    std::uint8_t& cell = obstacles_[row * cols_ + col];
+    if (cell != (blocked ? 1 : 0)) {
+        terrainHash_ ^= cellKey(row * cols_ + col);
+        for (int level = 1; level <= kPyramidLevels; ++level) {
+            std::uint16_t& count = pyramid_[levelOffset_[level] + (row >> level) * blockCols(level) + (col >> level)];
+            count = blocked ? count + 1 : count - 1;
+        }
+    }
+    cell = blocked ? 1 : 0;
+    const std::uint64_t bit = std::uint64_t{1} << (col % 64);
+    if (blocked) {
+        rowBits_[row * rowWords_ + col / 64] |= bit;
+    } else {
+        rowBits_[row * rowWords_ + col / 64] &= ~bit;
+    }
+}
+
+void World::generateIslands(const IslandParams& islands) {
+    // 生成器直接产出按行打包的位图，再展开成逐格数组
+    ::generateIslands(islands, rows_, cols_, rowBits_);
+    for (int r = 0; r < rows_; ++r) {
+        for (int c = 0; c < cols_; ++c) {
+            obstacles_[r * cols_ + c] = (rowBits_[r * rowWords_ + c / 64] >> (c % 64)) & 1;
+            if (obstacles_[r * cols_ + c]) terrainHash_ ^= cellKey(r * cols_ + c);
+        }
+    }
+    buildPyramid();
+}
+
+void World::spawnArea(int& top, int& bottom, int& left, int& right) const {
     // Player spawns near bottom center; clear a small rectangle.
-    const int centerRow = kRows - 2;
-    const int centerCol = kCols / 2;
+    const int centerRow = rows_ - 2;
+    const int centerCol = cols_ / 2;
+    top = std::max(0, centerRow - 3);
+    bottom = std::min(rows_ - 1, centerRow + 1);
+    left = std::max(0, centerCol - 6);
+    right = std::min(cols_ - 1, centerCol + 6);
+}
 
-    for (int r = centerRow - 3; r <= centerRow + 1; ++r) {
-        for (int c = centerCol - 6; c <= centerCol + 6; ++c) {
-            if (inBounds(r, c)) {
-                obstacles_[r][c] = false;
-            }
+void World::clearSpawnArea() {
+    int top, bottom, left, right;
+    spawnArea(top, bottom, left, right);
+    for (int r = top; r <= bottom; ++r) {
+        for (int c = left; c <= right; ++c) {
+            setObstacle(r, c, false);
         }
     }
 }
 
-bool World::loadFromFile(const std::string& path) {
+bool World::parseMapFile(const std::string& path, std::vector<std::uint8_t>& grid) const {
     std::ifstream in(path);
     if (!in.is_open()) return false;
 
-    clearAll();
+    grid.assign((std::size_t)rows_ * cols_, 0);
 
     std::string line;
     int row = 0;
     bool sawAnyCell = false;
-    while (row < kRows && std::getline(in, line)) {
+    while (row < rows_ && std::getline(in, line)) {
         // Skip completely empty lines.
         bool hasNonSpace = false;
         for (char ch : line) {
@@ -81,20 +207,12 @@ bool World::loadFromFile(const std::string& path) {
         int col = 0;
         for (char ch : line) {
             if (ch == ' ' || ch == '\t' || ch == '\r') continue;
-            if (col >= kCols) break;
+            if (col >= cols_) break;
 
             // '.' or '0' => empty; '#', '1', 'X' => blocked.
-            if (ch == '#' || ch == '1' || ch == 'X' || ch == 'x') {
-                obstacles_[row][col] = true;
-                sawAnyCell = true;
-            } else if (ch == '.' || ch == '0') {
-                obstacles_[row][col] = false;
-                sawAnyCell = true;
-            } else {
-                // Unknown character: treat as empty but still count as a cell.
-                obstacles_[row][col] = false;
-                sawAnyCell = true;
-            }
+            // Unknown characters are treated as empty but still count as a cell.
+            grid[row * cols_ + col] = (ch == '#' || ch == '1' || ch == 'X' || ch == 'x') ? 1 : 0;
+            sawAnyCell = true;
             col++;
         }
         // Missing columns stay empty.
@@ -105,11 +223,54 @@ bool World::loadFromFile(const std::string& path) {
     return sawAnyCell;
 }
 
+bool World::loadFromFile(const std::string& path) {
+    if (!parseMapFile(path, scratch_)) return false;
+
+    for (int r = 0; r < rows_; ++r) {
+        for (int c = 0; c < cols_; ++c) {
+            setObstacle(r, c, scratch_[r * cols_ + c] != 0);
+        }
+    }
+    return true;
+}
+
+bool World::reloadFromFile(const std::string& path) {
+    if (!parseMapFile(path, scratch_)) return false;
+
+    // 出生区域与首次加载时一样保持空旷
+    int top, bottom, left, right;
+    spawnArea(top, bottom, left, right);
+    for (int r = top; r <= bottom; ++r) {
+        std::memset(&scratch_[r * cols_ + left], 0, (std::size_t)(right - left + 1));
+    }
+
+    // 逐行比较，整行相同的直接跳过；只改动真正变化的格子
+    for (int r = 0; r < rows_; ++r) {
+        const std::uint8_t* next = &scratch_[r * cols_];
+        const std::uint8_t* live = &obstacles_[r * cols_];
+        if (std::memcmp(next, live, (std::size_t)cols_) == 0) continue;
+        for (int c = 0; c < cols_; ++c) {
+            if (next[c] == live[c]) continue;
+            setObstacle(r, c, next[c] != 0);
+            growingPush(dirty_, CellChange{r, c, next[c] != 0});
+        }
+    }
+    return true;
+}
+
+bool World::setBlocked(int row, int col, bool blocked) {
+    if (!inBounds(row, col)) return false;
+    if ((obstacles_[row * cols_ + col] != 0) == blocked) return false;
+    setObstacle(row, col, blocked);
+    growingPush(dirty_, CellChange{row, col, blocked});
+    return true;
+}
+
 bool World::inBounds(int row, int col) const {
-    return row >= 0 && row < kRows && col >= 0 && col < kCols;
+    return row >= 0 && row < rows_ && col >= 0 && col < cols_;
 }
 
 bool World::isBlocked(int row, int col) const {
     if (!inBounds(row, col)) return true;
-    return obstacles_[row][col];
+    return obstacles_[row * cols_ + col] != 0;
 }
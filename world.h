@@ -1,22 +1,84 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "island_generator.h"
+
+// 地形变化的一格（热重载地图、投射物侵蚀岛屿时产生）
+struct CellChange {
+    int row;
+    int col;
+    bool blocked; // 变化后的状态
+};
 
 class World {
 public:
-    static constexpr int kRows = 30;
-    static constexpr int kCols = 80;
+    // 关卡模式的地图尺寸，也是屏幕上游戏区（视口）的尺寸
+    static constexpr int kDefaultRows = 30;
+    static constexpr int kDefaultCols = 80;
+
+    World(); // 没有格子的空地图：只作占位，不取随机数、不生成地形，等关卡开始时整张换掉
+    World(int rows, int cols, const IslandParams& islands);
+    explicit World(const std::string& mapFilePath); // Load map from file (fallback to random islands)
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int rowWords() const { return rowWords_; }
+
+    // 重新读取地图文件，与当前地形逐格比较，只改动变化的格子（记入脏集合）。
+    // 尺寸保持不变；文件无法读取或没有内容时返回 false，地形不变。
+    bool reloadFromFile(const std::string& path);
 
-    World(); // Random obstacles
-    explicit World(const std::string& mapFilePath); // Load map from file (fallback to random)
+    // 运行中改动一格地形（侵蚀、漂移的障碍等）；界外或与现状相同时什么也不做，返回 false
+    bool setBlocked(int row, int col, bool blocked);
+
+    // 脏集合：上次 clearDirty() 以来变化的格子，按发生顺序（同一格可能出现多次，以当前地形为准）。
+    // 由地形派生的数据（视野缓存、开局放置表、被埋住的实体）据此增量更新，不整张重建
+    const std::vector<CellChange>& dirty() const { return dirty_; }
+    void clearDirty() { dirty_.clear(); }
 
     bool inBounds(int row, int col) const;
     bool isBlocked(int row, int col) const;
 
+    // 按行打包的障碍位图：第 col 列对应 rowWord(row, col / 64) 的第 col % 64 位
+    std::uint64_t rowWord(int row, int word) const { return rowBits_[row * rowWords_ + word]; }
+
+    // 地形哈希：所有障碍格的固定键异或而成，改动一格只需异或一次
+    std::uint64_t terrainHash() const { return terrainHash_; }
+
+    // 障碍计数金字塔：第 level 层（1..kPyramidLevels）的每一格统计地图上一个对齐的
+    // 2^level × 2^level 块里有几个障碍格（块伸出地图的部分按空地算）。改动一格只需沿各层加减 1
+    static constexpr int kPyramidLevels = 6;
+    int blockRows(int level) const { return (rows_ + (1 << level) - 1) >> level; }
+    int blockCols(int level) const { return (cols_ + (1 << level) - 1) >> level; }
+    int blockCount(int level, int blockRow, int blockCol) const {
+        return pyramid_[levelOffset_[level] + blockRow * blockCols(level) + blockCol];
+    }
+    // 粗查：矩形（裁剪到地图内）里可能有障碍时返回 true，返回 false 时一定没有。
+    // 在边长不小于矩形的那一层上最多查 2 × 2 个块，与矩形大小无关
+    bool mayBeBlocked(int top, int left, int height, int width) const;
+    // 精确查询：先用 mayBeBlocked 排除空旷区域，再用被矩形完全盖住的块确认有障碍，都不行才按行位图逐字检查
+    bool anyBlocked(int top, int left, int height, int width) const;
+
 private:
     void clearAll();
     void clearSpawnArea();
-    void generateRandomObstacles();
+    void generateIslands(const IslandParams& islands);
+    void spawnArea(int& top, int& bottom, int& left, int& right) const;
+    bool parseMapFile(const std::string& path, std::vector<std::uint8_t>& grid) const;
     bool loadFromFile(const std::string& path);
+    void setObstacle(int row, int col, bool blocked);
+    void buildPyramid();
+    static std::uint64_t cellKey(int index);
 
-    bool obstacles_[kRows][kCols];
+    int rows_;
+    int cols_;
+    int rowWords_; // 每行障碍位图占用的 64 位字数
+    std::vector<std::uint8_t> obstacles_;
+    std::vector<std::uint64_t> rowBits_;
+    std::vector<std::uint8_t> scratch_; // 读取地图文件用的暂存网格，重载时复用
+    std::vector<CellChange> dirty_;
+    std::vector<std::uint16_t> pyramid_; // 各层按行存放，第 level 层从 levelOffset_[level] 开始
+    int levelOffset_[kPyramidLevels + 1] = {};
+    std::uint64_t terrainHash_ = 0;
 };